@@ -0,0 +1,344 @@
+#ifndef ANGLEFILTER_H
+#define ANGLEFILTER_H
+
+#include <Arduino.h>
+
+// ---------------- Angle filter pipeline ----------------
+// Filter stages for circular angles in centidegrees (0..35999, where 35999 and 0 are
+// 0.01° apart). A pipeline is a type: AngleFilter<A, B, C> runs every sample through
+// A, then B, then C. Stage parameters are template arguments, so a stage that is not
+// listed is never compiled in and the arithmetic of the listed ones folds to constants.
+//
+//   AngleFilter<MedianStage<3>, IirStage<12>, DeadbandStage<10>, ZeroSnapStage<20> > f;
+//   uint16_t shown = f.process(sample100);
+//
+// Stage interface:
+//   uint16_t process(uint16_t a);  // One sample in, one sample out (0..35999)
+//   void reset(uint16_t a);        // Forget history; behave as if settled at a
+//   bool sameState(const Stage& o) const;  // True if both give the same outputs from here on
+
+namespace anglefilter {
+  static const uint16_t FULL = 36000;
+  static const uint16_t HALF = 18000;
+
+  // floor(sqrt(n)) at compile time: binary search between lo and hi
+  constexpr uint32_t isqrt(uint32_t n, uint32_t lo = 0, uint32_t hi = 65535) {
+    return (lo == hi) ? lo
+         : ((uint32_t)((lo + hi + 1) / 2) * ((lo + hi + 1) / 2) <= n) ? isqrt(n, (lo + hi + 1) / 2, hi)
+         : isqrt(n, lo, (lo + hi + 1) / 2 - 1);
+  }
+
+  // Shortest signed distance from b to a: -18000..17999
+  inline int16_t diff(uint16_t a, uint16_t b) {
+    int32_t d = (int32_t)a - (int32_t)b;
+    if (d >= HALF) d -= FULL;
+    else if (d < -(int32_t)HALF) d += FULL;
+    return (int16_t)d;
+  }
+
+  // Bring -36000..71999 back to 0..35999
+  inline uint16_t wrap(int32_t a) {
+    if (a < 0) a += FULL;
+    else if (a >= FULL) a -= FULL;
+    return (uint16_t)a;
+  }
+
+  inline uint16_t absDiff(uint16_t a, uint16_t b) {
+    int16_t d = diff(a, b);
+    return (uint16_t)(d < 0 ? -d : d);
+  }
+}
+
+// Median of the last N samples (N odd, 3..9): removes single-sample spikes.
+// Samples are ranked by their distance from the previous output, so a window
+// straddling 0/360° is ordered correctly even when the spike is half a turn away.
+template <uint8_t N>
+class MedianStage {
+  static_assert((N & 1) && N >= 3 && N <= 9, "MedianStage: N must be odd, 3..9");
+public:
+  MedianStage() : out_(0), head_(0), count_(0) {}
+
+  uint16_t process(uint16_t a) {
+    if (count_ == 0) out_ = a;
+    buf_[head_] = a;
+    head_ = (head_ + 1 < N) ? head_ + 1 : 0;
+    if (count_ < N) count_++;
+
+    // Insertion sort of the offsets relative to the previous output (at most 9 entries)
+    int16_t off[N];
+    for (uint8_t i = 0; i < count_; i++) {
+      int16_t d = anglefilter::diff(buf_[i], out_);
+      uint8_t j = i;
+      while (j > 0 && off[j - 1] > d) {
+        off[j] = off[j - 1];
+        j--;
+      }
+      off[j] = d;
+    }
+    out_ = anglefilter::wrap((int32_t)out_ + off[(count_ - 1) / 2]);
+    return out_;
+  }
+
+  void reset(uint16_t a) {
+    for (uint8_t i = 0; i < N; i++) buf_[i] = a;
+    out_ = a;
+    head_ = 0;
+    count_ = N;
+  }
+
+  // Compares the window oldest-first, so the ring position does not matter
+  bool sameState(const MedianStage& o) const {
+    if (count_ != o.count_ || out_ != o.out_) return false;
+    uint8_t i = (head_ + N - count_) % N, j = (o.head_ + N - count_) % N;
+    for (uint8_t k = 0; k < count_; k++) {
+      if (buf_[i] != o.buf_[j]) return false;
+      i = (i + 1 < N) ? i + 1 : 0;
+      j = (j + 1 < N) ? j + 1 : 0;
+    }
+    return true;
+  }
+
+private:
+  uint16_t buf_[N];
+  uint16_t out_;  // Previous output: reference point for ranking
+  uint8_t head_;
+  uint8_t count_;
+};
+
+// One-pole low-pass: y += (x - y) * ALPHA / 256, along the shorter way around the
+// circle. State is kept in 1/256 centidegree so small steps are not lost to rounding.
+// Time constant ~ 256 / ALPHA samples. The first sample seeds the state.
+template <uint8_t ALPHA>
+class IirStage {
+  static_assert(ALPHA >= 1, "IirStage: ALPHA must be 1..255");
+public:
+  IirStage() : y_(0), seeded_(false) {}
+
+  uint16_t process(uint16_t a) {
+    const int32_t FULL_Q = (int32_t)anglefilter::FULL << 8;
+    if (!seeded_) {
+      reset(a);
+      return a;
+    }
+    int32_t d = ((int32_t)a << 8) - y_;
+    if (d >= FULL_Q / 2) d -= FULL_Q;
+    else if (d < -FULL_Q / 2) d += FULL_Q;
+    y_ += (d * ALPHA) >> 8;
+    if (y_ < 0) y_ += FULL_Q;
+    else if (y_ >= FULL_Q) y_ -= FULL_Q;
+
+    uint16_t out = (uint16_t)((y_ + 128) >> 8);
+    return (out >= anglefilter::FULL) ? 0 : out;
+  }
+
+  void reset(uint16_t a) {
+    y_ = (int32_t)a << 8;
+    seeded_ = true;
+  }
+
+  bool sameState(const IirStage& o) const {
+    return seeded_ == o.seeded_ && y_ == o.y_;
+  }
+
+private:
+  int32_t y_;  // Filtered angle, centidegrees * 256
+  bool seeded_;
+};
+
+// Alpha-beta tracker: estimates angle and angular velocity together, so a moving
+// input is followed without the lag of a plain low-pass. Gains switch between a
+// strongly smoothing rest pair and a fast moving pair: moving while the prediction
+// error exceeds MOVE_BAND (centidegrees), rest again once it drops below MOVE_BAND/2.
+// Beta follows from alpha for critical damping (beta = 2 - alpha - 2 sqrt(1 - alpha): no
+// ringing); the velocity correction is limited while the error is a jump rather than a
+// speed change, so a step settles without overshoot. At rest the velocity also decays,
+// so a still sensor reads 0 °/s.
+// SAMPLE_US is the sample period, used only to scale rate10().
+template <uint8_t ALPHA_REST, uint8_t ALPHA_MOVE, uint16_t MOVE_BAND, uint32_t SAMPLE_US>
+class AlphaBetaStage {
+  static_assert(ALPHA_REST >= 1 && ALPHA_MOVE >= ALPHA_REST, "AlphaBetaStage: 1 <= ALPHA_REST <= ALPHA_MOVE");
+  // Critically damped beta in 1/65536 (rest gains are too small for /256):
+  // 65536 * (2 - a - 2 sqrt(1 - a)) with a = ALPHA / 256
+  static const uint16_t BETA_REST = 131072UL - 256UL * ALPHA_REST - 2 * anglefilter::isqrt((256UL - ALPHA_REST) << 24);
+  static const uint16_t BETA_MOVE = 131072UL - 256UL * ALPHA_MOVE - 2 * anglefilter::isqrt((256UL - ALPHA_MOVE) << 24);
+  // rate10 = v / 256 * (10^6 / SAMPLE_US) / 10 = (v * RATE_K) >> 16
+  static const uint32_t RATE_K = (1600000UL * 16UL + SAMPLE_US / 2) / SAMPLE_US;
+public:
+  AlphaBetaStage() : x_(0), v_(0), seeded_(false), moving_(false) {}
+
+  uint16_t process(uint16_t a) {
+    const int32_t FULL_Q = (int32_t)anglefilter::FULL << 8;
+    if (!seeded_) {
+      reset(a);
+      return a;
+    }
+    // Predict one sample ahead, then correct by the wrapped prediction error
+    int32_t xp = x_ + v_;
+    int32_t r = ((int32_t)a << 8) - xp;
+    while (r >= FULL_Q / 2) r -= FULL_Q;
+    while (r < -FULL_Q / 2) r += FULL_Q;
+
+    int32_t ar = (r < 0) ? -r : r;
+    if (ar > ((int32_t)MOVE_BAND << 8)) moving_ = true;
+    else if (ar < ((int32_t)MOVE_BAND << 7)) moving_ = false;
+
+    // r >> 4 (1/16 centidegree) keeps r * beta within 32 bits for a half-turn error
+    if (moving_) {
+      x_ = xp + ((r * ALPHA_MOVE) >> 8);
+      // An error far above the band is a jump, not a velocity error: fed in whole it
+      // would wind the velocity up and the tracker would overshoot the new level by
+      // degrees. Past the target (error against the velocity), brake instead.
+      const int32_t RV_MAX = (int32_t)MOVE_BAND << 6;  // MOVE_BAND / 4
+      int32_t rv = (r > RV_MAX) ? RV_MAX : (r < -RV_MAX) ? -RV_MAX : r;
+      v_ += ((rv >> 4) * (int32_t)BETA_MOVE) >> 12;
+      if ((r ^ v_) < 0) v_ -= v_ >> 1;
+    } else {
+      // At rest the slow beta cannot remove velocity left over from a move before it
+      // overshoots: let it decay (~16 samples), and drop it once the angle is past the
+      // input, so the tracker settles without ringing
+      x_ = xp + ((r * ALPHA_REST) >> 8);
+      v_ += ((r >> 4) * (int32_t)BETA_REST) >> 12;
+      v_ -= v_ >> 4;
+      if ((r ^ v_) < 0) v_ = 0;
+    }
+    while (x_ < 0) x_ += FULL_Q;
+    while (x_ >= FULL_Q) x_ -= FULL_Q;
+
+    uint16_t out = (uint16_t)((x_ + 128) >> 8);
+    return (out >= anglefilter::FULL) ? 0 : out;
+  }
+
+  void reset(uint16_t a) {
+    x_ = (int32_t)a << 8;
+    v_ = 0;
+    seeded_ = true;
+    moving_ = false;
+  }
+
+  bool sameState(const AlphaBetaStage& o) const {
+    return seeded_ == o.seeded_ && x_ == o.x_ && v_ == o.v_ && moving_ == o.moving_;
+  }
+
+  // Angular velocity in 0.1 °/s (positive = increasing angle)
+  int16_t rate10() const {
+    int32_t r = (v_ * (int32_t)RATE_K) >> 16;  // No overflow below ~3000 °/s
+    if (r > 32767) r = 32767;
+    else if (r < -32767) r = -32767;
+    return (int16_t)r;
+  }
+
+  bool isMoving() const { return moving_; }
+
+private:
+  int32_t x_;  // Angle, centidegrees * 256
+  int32_t v_;  // Velocity, centidegrees * 256 per sample
+  bool seeded_;
+  bool moving_;
+};
+
+// Hysteresis: the output only follows the input once it has moved BAND or more away,
+// so the last digit does not flicker on noise.
+template <uint16_t BAND>
+class DeadbandStage {
+public:
+  DeadbandStage() : out_(0), seeded_(false) {}
+
+  uint16_t process(uint16_t a) {
+    if (!seeded_ || anglefilter::absDiff(a, out_) >= BAND) {
+      out_ = a;
+      seeded_ = true;
+    }
+    return out_;
+  }
+
+  void reset(uint16_t a) {
+    out_ = a;
+    seeded_ = true;
+  }
+
+  bool sameState(const DeadbandStage& o) const {
+    return seeded_ == o.seeded_ && out_ == o.out_;
+  }
+
+private:
+  uint16_t out_;
+  bool seeded_;
+};
+
+// Shows exactly 0 while the angle is within THRESHOLD of zero (either side), so a
+// freshly zeroed sensor reads 0.00° instead of drifting by a few hundredths.
+template <uint16_t THRESHOLD>
+class ZeroSnapStage {
+public:
+  uint16_t process(uint16_t a) {
+    return (anglefilter::absDiff(a, 0) <= THRESHOLD) ? 0 : a;
+  }
+  void reset(uint16_t) {}
+  bool sameState(const ZeroSnapStage&) const { return true; }
+};
+
+namespace anglefilter {
+  // Compile-time chain of stages; the empty base ends the recursion at no cost
+  template <class... Stages>
+  struct Chain {
+    uint16_t process(uint16_t a) { return a; }
+    void reset(uint16_t) {}
+    bool sameState(const Chain&) const { return true; }
+    void find();  // Overload anchor for stage lookup by type
+  };
+
+  template <class First, class... Rest>
+  struct Chain<First, Rest...> : Chain<Rest...> {
+    First stage;
+
+    using Chain<Rest...>::find;
+    First& find(First*) { return stage; }
+    const First& find(First*) const { return stage; }
+
+    uint16_t process(uint16_t a) {
+      return Chain<Rest...>::process(stage.process(a));
+    }
+    void reset(uint16_t a) {
+      stage.reset(a);
+      Chain<Rest...>::reset(a);
+    }
+    bool sameState(const Chain& o) const {
+      return stage.sameState(o.stage) && Chain<Rest...>::sameState(o);
+    }
+  };
+}
+
+template <class... Stages>
+class AngleFilter {
+public:
+  AngleFilter() : out_(0) {}
+
+  // Feed one sample (0..35999); returns the new output
+  uint16_t process(uint16_t a) {
+    out_ = chain_.process(a);
+    return out_;
+  }
+
+  // Restart all stages settled at a (e.g. after the zero offset changed)
+  void reset(uint16_t a) {
+    chain_.reset(a);
+    out_ = a;
+  }
+
+  // Last output
+  uint16_t value() const { return out_; }
+
+  // True if both filters give the same outputs for the same input from here on: a
+  // filter restarted part way through a log has caught up with one that saw all of it
+  bool sameState(const AngleFilter& o) const { return chain_.sameState(o.chain_); }
+
+  // Access a stage by type, e.g. f.stage<AlphaBetaStage<...> >().rate10()
+  template <class S>
+  const S& stage() const { return chain_.find((S*)0); }
+
+private:
+  anglefilter::Chain<Stages...> chain_;
+  uint16_t out_;
+};
+
+#endif // ANGLEFILTER_H
@@ -0,0 +1,235 @@
+#include "ButtonBank.h"
+
+static_assert(ButtonBank::BTN_COUNT == buttonio::COUNT, "one pin per ButtonId");
+
+#if defined(BUTTON_PCINT)
+// ---------------- Edge queue (PCINT ISR -> update()) ----------------
+// Single producer / single consumer ring: only the producer writes edgeHead_, only the
+// consumer writes edgeTail_; both are single bytes, so no locking is needed
+static const uint8_t EDGE_QUEUE_SIZE = 16;  // Power of two; 4 bytes RAM per entry
+static volatile uint16_t edgeMs_[EDGE_QUEUE_SIZE];
+static volatile ButtonBank::Mask edgeLevel_[EDGE_QUEUE_SIZE];
+static volatile uint8_t edgeHead_ = 0;
+static volatile uint8_t edgeTail_ = 0;
+static volatile bool edgeOverflow_ = false;      // Producer stopped queueing, consumer must resync
+static volatile uint16_t edgeOverflowCount_ = 0;
+static ButtonBank::Mask edgeLast_ = 0;           // Last queued level (producer only)
+
+#if defined(BUTTON_PCINT_ISR)
+// Default pinout: D2..D4 on PORTD (PCINT2), D9 on PORTB (PCINT0)
+static_assert(buttonio::portMask(0x28) == 0, "no PCINT1 vector for buttons on PORTC");
+ISR(PCINT0_vect) { ButtonBank::onPinChange(); }
+ISR(PCINT2_vect, ISR_ALIASOF(PCINT0_vect));
+#endif
+
+void ButtonBank::onPinChange() {
+  Mask level = sample();
+  if (level == edgeLast_ || edgeOverflow_) return;
+
+  uint8_t head = edgeHead_;
+  uint8_t next = (head + 1) & (EDGE_QUEUE_SIZE - 1);
+  if (next == edgeTail_) {
+    edgeOverflow_ = true;
+    edgeOverflowCount_++;
+    return;
+  }
+  edgeMs_[head] = (uint16_t)millis();
+  edgeLevel_[head] = level;
+  edgeLast_ = level;
+  edgeHead_ = next;  // Publish after the entry is complete
+}
+
+uint16_t ButtonBank::getEdgeOverflows() {
+  noInterrupts();
+  uint16_t n = edgeOverflowCount_;
+  interrupts();
+  return n;
+}
+#endif
+
+ButtonBank::ButtonBank()
+  : state_(0), presses_(0), releases_(0), clicks_(0), longs_(0), longFired_(0),
+    repeating_(0), repeated_(0), repeatNextMs_(0)
+#if defined(BUTTON_PCINT)
+  , raw_(0), rawSinceMs_(0)
+#else
+  , cnt0_((Mask)~0), cnt1_((Mask)~0)
+#endif
+{
+  for (uint8_t i = 0; i < BTN_COUNT; i++) {
+  #if defined(BUTTON_PCINT)
+    pressMs_[i] = 0;
+  #else
+    holdTicks_[i] = 0;
+  #endif
+  }
+}
+
+void ButtonBank::begin() {
+  for (uint8_t i = 0; i < BTN_COUNT; i++) pinMode(buttonio::pinOf(i), INPUT_PULLUP);
+
+  state_ = 0;
+  presses_ = releases_ = clicks_ = longs_ = longFired_ = 0;
+  repeating_ = repeated_ = 0;
+#if defined(BUTTON_PCINT)
+  noInterrupts();
+  edgeHead_ = edgeTail_ = 0;
+  edgeOverflow_ = false;
+  edgeLast_ = raw_ = sample();  // Buttons already held at power-up count as pressed once stable
+  rawSinceMs_ = (uint16_t)millis();
+  #if defined(BUTTON_PCINT_ISR)
+    PCMSK0 |= buttonio::portMask(0x25);
+    PCMSK2 |= buttonio::portMask(0x2B);
+    PCIFR = (1 << PCIF0) | (1 << PCIF2);
+    if (buttonio::portMask(0x25)) PCICR |= (1 << PCIE0);
+    if (buttonio::portMask(0x2B)) PCICR |= (1 << PCIE2);
+  #endif
+  interrupts();
+#else
+  cnt0_ = cnt1_ = (Mask)~0;  // Counters idle at 3
+#endif
+}
+
+ButtonBank::Mask ButtonBank::sample() {
+#if defined(FASTPIN_SUPPORTED)
+  // LOW = pressed (pullup)
+  using namespace buttonio;
+  Mask m = (uint8_t)~fastpin::pinReg(PORT0) & portMask(PORT0);
+  if (PORT1 != PORT0) m |= (Mask)((uint8_t)~fastpin::pinReg(PORT1) & portMask(PORT1)) << 8;
+  return m;
+#else
+  Mask m = 0;
+  for (uint8_t i = 0; i < BTN_COUNT; i++) {
+    if (!digitalRead(buttonio::pinOf(i))) m |= bit((ButtonId)i);
+  }
+  return m;
+#endif
+}
+
+#if defined(BUTTON_PCINT)
+void ButtonBank::update() {
+  #if !defined(BUTTON_PCINT_ISR)
+    onPinChange();  // No pin-change interrupt for every button pin: sample once per tick
+  #endif
+
+  // Replay queued edges: the level before an edge was stable if the edge came
+  // DEBOUNCE_MS or more after it (bounces are closer together and cancel out)
+  while (edgeTail_ != edgeHead_) {
+    uint8_t tail = edgeTail_;
+    uint16_t ms = edgeMs_[tail];
+    Mask level = edgeLevel_[tail];
+    edgeTail_ = (tail + 1) & (EDGE_QUEUE_SIZE - 1);
+
+    if ((uint16_t)(ms - rawSinceMs_) >= DEBOUNCE_MS) commit(raw_, rawSinceMs_);
+    raw_ = level;
+    rawSinceMs_ = ms;
+  }
+
+  uint16_t now = (uint16_t)millis();
+  if (edgeOverflow_) {
+    // Edges were dropped: take the current pin level as a fresh edge
+    noInterrupts();
+    edgeLast_ = sample();
+    edgeOverflow_ = false;
+    interrupts();
+    if ((uint16_t)(now - rawSinceMs_) >= DEBOUNCE_MS) commit(raw_, rawSinceMs_);
+    raw_ = edgeLast_;
+    rawSinceMs_ = now;
+  }
+  if ((uint16_t)(now - rawSinceMs_) >= DEBOUNCE_MS) commit(raw_, rawSinceMs_);
+
+  // Long press while held
+  Mask timing = state_ & (Mask)~longFired_;
+  if (!timing) return;
+  for (uint8_t i = 0; i < BTN_COUNT; i++) {
+    Mask b = bit((ButtonId)i);
+    if ((timing & b) && (uint16_t)(now - pressMs_[i]) >= LONG_PRESS_MS) {
+      longs_ |= b;
+      longFired_ |= b;
+    }
+  }
+}
+
+void ButtonBank::commit(Mask level, uint16_t atMs) {
+  Mask toggled = level ^ state_;
+  if (!toggled) return;
+  state_ = level;
+
+  Mask down = toggled & level;
+  Mask up = toggled & (Mask)~level;
+  for (uint8_t i = 0; i < BTN_COUNT; i++) {
+    Mask b = bit((ButtonId)i);
+    if (down & b) {
+      pressMs_[i] = atMs;
+    } else if ((up & b) && !(longFired_ & b) && (uint16_t)(atMs - pressMs_[i]) >= LONG_PRESS_MS) {
+      // Whole long press happened while update() was not running: report it late
+      longs_ |= b;
+      longFired_ |= b;
+    }
+  }
+  presses_ |= down;
+  releases_ |= up;
+  clicks_ |= up & (Mask)~longFired_;
+  longFired_ &= (Mask)~down;
+}
+#else
+void ButtonBank::update() {
+  // 2-bit vertical counters: count samples that differ from the debounced state,
+  // reset to 3 on an equal sample; the 4th differing sample in a row toggles the state
+  Mask delta = sample() ^ state_;
+  cnt0_ = (Mask)~(cnt0_ & delta);
+  cnt1_ = (Mask)(cnt0_ ^ (cnt1_ & delta));
+  Mask toggled = delta & cnt0_ & cnt1_;
+  state_ ^= toggled;
+
+  Mask down = toggled & state_;
+  Mask up = toggled & (Mask)~state_;
+  presses_ |= down;
+  releases_ |= up;
+  clicks_ |= up & (Mask)~longFired_;
+  longFired_ &= (Mask)~down;
+
+  // Long press: ticks since the press was confirmed, only for buttons still waiting for it
+  Mask timing = state_ & (Mask)~longFired_;
+  if (!timing) return;
+  for (uint8_t i = 0; i < BTN_COUNT; i++) {
+    Mask b = bit((ButtonId)i);
+    if (!(timing & b)) continue;
+    if (down & b) {
+      holdTicks_[i] = 0;
+    } else if (++holdTicks_[i] >= LONG_PRESS_TICKS) {
+      longs_ |= b;
+      longFired_ |= b;
+    }
+  }
+}
+#endif
+
+void ButtonBank::emitEvents(InputQueue& q) {
+  uint16_t now = (uint16_t)millis();
+  Mask presses = takePresses();
+  Mask releases = takeReleases();
+  Mask clicks = takeClicks();
+  Mask longs = takeLongPresses();
+
+  // Auto-repeat: the most recently pressed repeat button, while it stays down
+  Mask rep = presses & REPEAT_BUTTONS;
+  if (rep) {
+    repeating_ = rep & (Mask)(~rep + 1);  // Lowest set bit
+    repeated_ &= (Mask)~rep;              // Every new press starts without repeats
+    repeatNextMs_ = now + REPEAT_DELAY_MS;
+  }
+  if (repeating_ && !(state_ & repeating_)) repeating_ = 0;
+
+  for (uint8_t i = 0; i < BTN_COUNT; i++) {
+    Mask b = bit((ButtonId)i);
+    if ((clicks & b) && !(repeated_ & b)) q.push(i, InputEvent::EV_CLICK, now);
+    if (longs & b) q.push(i, InputEvent::EV_LONG, now);
+    if ((releases & b) && (longFired_ & b)) q.push(i, InputEvent::EV_LONG_RELEASE, now);
+    if ((repeating_ & b) && (int16_t)(now - repeatNextMs_) >= 0) {
+      q.push(i, InputEvent::EV_REPEAT, now);
+      repeated_ |= b;
+      repeatNextMs_ += REPEAT_INTERVAL_MS;
+    }
+  }
+}
@@ -0,0 +1,155 @@
+#ifndef BUTTONBANK_H
+#define BUTTONBANK_H
+
+#include <Arduino.h>
+#include "Config.h"
+#include "FastPin.h"
+#include "InputEvent.h"
+
+// Pin of each ButtonBank::ButtonId (enum order) and, on boards with a FastPin table,
+// the ports they sit on: buttons on PORT0 use Mask bits 0..7, buttons on PORT1 bits 8..15
+namespace buttonio {
+
+constexpr uint8_t COUNT = 4;
+
+constexpr uint8_t pinOf(uint8_t id) {
+  return id == 0 ? PIN_BTN_UP : id == 1 ? PIN_BTN_DOWN : id == 2 ? PIN_BTN_OK : PIN_BTN_BACK;
+}
+
+#if defined(FASTPIN_SUPPORTED)
+constexpr uint8_t portOf(uint8_t id) { return fastpin::portAddr(pinOf(id)); }
+
+// First port after `first` that has a button (or `first` if all share it)
+constexpr uint8_t otherPort(uint8_t first, uint8_t id = 0) {
+  return id >= COUNT ? first : portOf(id) != first ? portOf(id) : otherPort(first, id + 1);
+}
+
+// PINx bits of the buttons on `port`
+constexpr uint8_t portMask(uint8_t port, uint8_t id = 0) {
+  return id >= COUNT ? 0
+       : (uint8_t)((portOf(id) == port ? fastpin::pinMask(pinOf(id)) : 0) | portMask(port, id + 1));
+}
+
+constexpr uint8_t PORT0 = portOf(0);
+constexpr uint8_t PORT1 = otherPort(PORT0);
+
+constexpr bool onTwoPorts(uint8_t id = 0) {
+  return id >= COUNT || ((portOf(id) == PORT0 || portOf(id) == PORT1) && onTwoPorts(id + 1));
+}
+static_assert(onTwoPorts(), "button pins must be on at most two ports");
+
+constexpr uint16_t bitOf(uint8_t id) {
+  return portOf(id) == PORT0 ? fastpin::pinMask(pinOf(id)) : (uint16_t)(fastpin::pinMask(pinOf(id)) << 8);
+}
+#else
+constexpr uint16_t bitOf(uint8_t id) { return (uint16_t)(1 << id); }
+#endif
+
+} // namespace buttonio
+
+// ---------------- ButtonBank (all buttons debounced together) ----------------
+// Samples every button with one PINx read per port (two at most). Long press fires
+// once, LONG_PRESS_MS after the press was confirmed; a click is a release without a
+// long press. Events are bitmasks (bit(id)) and stay set until taken.
+//
+// Polled (default): update() samples and debounces all buttons in parallel with 2-bit
+// vertical counters: a button changes state after 4 equal samples in a row, i.e. 30 ms
+// at BUTTON_TICK_MS = 10 (same as Button's 25 ms debounce).
+//
+// BUTTON_PCINT: a pin-change interrupt samples the ports on every edge and queues
+// {millis, level} in a lock-free single-producer/single-consumer ring; update() replays
+// the queue, so a level counts as debounced once no edge followed it for DEBOUNCE_MS,
+// judged by the edge timestamps. Presses are captured even while loop() is busy.
+#if defined(BUTTON_PCINT) && (defined(__AVR_ATmega328P__) || defined(__AVR_ATmega328__))
+  #define BUTTON_PCINT_ISR  // Edges queued by PCINT0/PCINT2 (otherwise update() samples)
+#endif
+
+class ButtonBank {
+public:
+  enum ButtonId : uint8_t {
+    BTN_UP = 0,
+    BTN_DOWN,
+    BTN_OK,
+    BTN_BACK,
+    BTN_COUNT  // = buttonio::COUNT
+  };
+  typedef uint16_t Mask;
+
+  ButtonBank();
+
+  // Configure the pins (INPUT_PULLUP)
+  void begin();
+
+  // Sample and debounce all buttons (call every BUTTON_TICK_MS)
+  void update();
+
+#if defined(BUTTON_PCINT)
+  // Producer side of the edge queue: sample the pins and queue the level if it changed
+  // (pin-change ISR; update() calls it on boards without BUTTON_PCINT_ISR)
+  static void onPinChange();
+
+  // Edges lost because the queue was full (the bank resynchronises from the pins)
+  static uint16_t getEdgeOverflows();
+#endif
+
+  // Bit of a button in every Mask
+  static constexpr Mask bit(ButtonId id) { return buttonio::bitOf(id); }
+
+  // Debounced state
+  Mask held() const { return state_; }
+  Mask longHeld() const { return state_ & longFired_; }  // Held and already long-pressed
+  bool isPressed(ButtonId id) const { return (state_ & bit(id)) != 0; }
+
+  // Events since the last take (read and clear)
+  Mask takePresses()     { Mask m = presses_;  presses_ = 0;  return m; }
+  Mask takeReleases()    { Mask m = releases_; releases_ = 0; return m; }
+  Mask takeClicks()      { Mask m = clicks_;   clicks_ = 0;   return m; }
+  Mask takeLongPresses() { Mask m = longs_;    longs_ = 0;    return m; }
+
+  // Single-button variants of takeClicks() / takeLongPresses() (same as Button)
+  bool wasPressed(ButtonId id) { return take(clicks_, bit(id)); }
+  bool wasLongPressed(ButtonId id) { return take(longs_, bit(id)); }
+
+  // Take this update()'s events and queue them as gestures (call right after update()):
+  // EV_CLICK, EV_LONG, EV_LONG_RELEASE, and EV_REPEAT for REPEAT_BUTTONS held longer
+  // than REPEAT_DELAY_MS (a press that auto-repeated ends without EV_CLICK)
+  void emitEvents(InputQueue& q);
+
+private:
+  static const uint16_t DEBOUNCE_MS = 25;      // Debounce time
+  static const uint16_t LONG_PRESS_MS = 600;   // Long press threshold
+  static const uint16_t REPEAT_DELAY_MS = 500;     // Hold time before auto-repeat starts
+  static const uint16_t REPEAT_INTERVAL_MS = 100;  // Auto-repeat period
+  static constexpr Mask REPEAT_BUTTONS = buttonio::bitOf(BTN_UP) | buttonio::bitOf(BTN_DOWN);
+
+  Mask state_;      // Debounced: 1 = pressed
+  Mask presses_;
+  Mask releases_;
+  Mask clicks_;
+  Mask longs_;
+  Mask longFired_;  // Long press already reported in the current press
+  Mask repeating_;  // Button currently auto-repeating (one bit or 0)
+  Mask repeated_;   // Buttons that auto-repeated in their current press
+  uint16_t repeatNextMs_;
+#if defined(BUTTON_PCINT)
+  Mask raw_;                      // Level of the last queued edge
+  uint16_t rawSinceMs_;           // Its timestamp (low 16 bits of millis())
+  uint16_t pressMs_[BTN_COUNT];   // Press timestamps for long press detection
+
+  void commit(Mask level, uint16_t atMs);
+#else
+  static const uint8_t LONG_PRESS_TICKS = (LONG_PRESS_MS + BUTTON_TICK_MS - 1) / BUTTON_TICK_MS;
+  Mask cnt0_;       // Vertical counter, bit 0 of every button's sample count
+  Mask cnt1_;       // Vertical counter, bit 1
+  uint8_t holdTicks_[BTN_COUNT];
+#endif
+
+  static Mask sample();
+  static bool take(Mask& events, Mask b) {
+    if (!(events & b)) return false;
+    events &= (Mask)~b;
+    return true;
+  }
+};
+
+#endif // BUTTONBANK_H
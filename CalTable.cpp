@@ -0,0 +1,134 @@
+#include "CalTable.h"
+#include "Sensor.h"
+#include "EepromWriter.h"
+#include "Crc16.h"
+#include <stddef.h>
+
+static CalTable table_;  // Also the source of queued EEPROM writes
+static const uint8_t INVALID_MAGIC = 0;
+static_assert(sizeof(CalTable) <= 255, "CalTable too large for one EEPROM writer job");
+static uint8_t known_[(CAL_POINTS + 7) / 8];  // Bit per point: value loaded or captured
+static bool active_ = false;
+
+// Version 1 header (the points follow it as in the current layout, 4 bytes earlier)
+struct CalTableHeaderV1 {
+  uint8_t version;    // 1
+  uint8_t points;
+  uint8_t extraBits;
+  uint8_t crc;        // XOR of the other header bytes and the points
+};
+
+static uint16_t calTableCrc(const CalTable& t) {
+  return crc16(t.adc, t.length, crc16(&t, offsetof(CalTable, crc)));
+}
+
+// Read a version 1 table into table_ (false if there is none for CAL_POINTS)
+static bool loadV1() {
+  CalTableHeaderV1 h;
+  EEPROM.get(CAL_TABLE_EEPROM_ADDR, h);
+  if (h.version != 1 || h.points != CAL_POINTS) return false;
+  EEPROM.get(CAL_TABLE_EEPROM_ADDR + (int)sizeof(h), table_.adc);
+  uint8_t c = h.version ^ h.points ^ h.extraBits;
+  const uint8_t* p = (const uint8_t*)table_.adc;
+  for (size_t i = 0; i < sizeof(table_.adc); i++) c ^= p[i];
+  if (c != h.crc) return false;
+  table_.extraBits = h.extraBits;
+  return true;
+}
+
+static void saveTable() {
+  table_.magic = CAL_TABLE_MAGIC;
+  table_.version = CAL_TABLE_VERSION;
+  table_.length = sizeof(table_.adc);
+  table_.extraBits = ADC_EXTRA_BITS;
+  table_.reserved = 0;
+  table_.crc = calTableCrc(table_);
+  eepromWriterWrite(CAL_TABLE_EEPROM_ADDR, &table_, sizeof(table_));
+}
+
+static void setKnown(uint8_t i, bool on) {
+  if (on) known_[i >> 3] |= (uint8_t)(1 << (i & 7));
+  else known_[i >> 3] &= (uint8_t)~(1 << (i & 7));
+}
+
+static bool allKnown() {
+  for (uint8_t i = 0; i < CAL_POINTS; i++) {
+    if (!calTableHasPoint(i)) return false;
+  }
+  return true;
+}
+
+static bool increasing() {
+  for (uint8_t i = 1; i < CAL_POINTS; i++) {
+    if (table_.adc[i] <= table_.adc[i - 1]) return false;
+  }
+  return table_.adc[CAL_POINTS - 1] <= ADC_MAX;
+}
+
+void calTableLoad() {
+  EEPROM.get(CAL_TABLE_EEPROM_ADDR, table_);
+  memset(known_, 0, sizeof(known_));
+  active_ = false;
+
+  bool outdated = false;  // Valid, but to be written again in the current format
+  if (table_.magic != CAL_TABLE_MAGIC || table_.version != CAL_TABLE_VERSION ||
+      table_.length != sizeof(table_.adc) || table_.crc != calTableCrc(table_)) {
+    if (!loadV1()) return;  // No table (first run, cleared, or saved with another CAL_POINTS)
+    outdated = true;
+  }
+
+  // Saved at another ADC resolution: rescale like the two-point calibration
+  if (table_.extraBits != ADC_EXTRA_BITS && table_.extraBits <= 4) {
+    for (uint8_t i = 0; i < CAL_POINTS; i++) table_.adc[i] = adcRescale(table_.adc[i], table_.extraBits);
+    table_.extraBits = ADC_EXTRA_BITS;
+    outdated = true;
+  }
+  if (table_.extraBits != ADC_EXTRA_BITS || !increasing()) return;
+
+  memset(known_, 0xFF, sizeof(known_));
+  active_ = true;
+  if (outdated) saveTable();
+}
+
+bool calTableActive() {
+  return active_;
+}
+
+uint16_t calTableAngle100(uint8_t i) {
+  return (uint16_t)((uint32_t)i * 36000UL / (CAL_POINTS - 1));
+}
+
+uint16_t calTableAdc(uint8_t i) {
+  return (i < CAL_POINTS) ? table_.adc[i] : 0;
+}
+
+bool calTableHasPoint(uint8_t i) {
+  return (i < CAL_POINTS) && (known_[i >> 3] & (1 << (i & 7)));
+}
+
+CalCaptureResult calTableCapture(uint8_t i, uint16_t adc) {
+  if (i >= CAL_POINTS) return CAL_CAPTURED;
+  uint16_t previous = table_.adc[i];
+  table_.adc[i] = adc;
+  setKnown(i, true);
+  if (!allKnown()) return CAL_CAPTURED;
+
+  if (!increasing()) {
+    // The table in use stays as it was; a new table waits for the remaining fixes
+    if (active_) table_.adc[i] = previous;
+    return CAL_NOT_MONOTONIC;
+  }
+  saveTable();
+  active_ = true;
+  sensorCalRebuild();
+  return CAL_SAVED;
+}
+
+void calTableClear() {
+  memset(known_, 0, sizeof(known_));
+  if (active_) {
+    active_ = false;
+    eepromWriterWrite(CAL_TABLE_EEPROM_ADDR, &INVALID_MAGIC, 1);  // Invalidate the magic
+    sensorCalRebuild();
+  }
+}
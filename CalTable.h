@@ -0,0 +1,58 @@
+#ifndef CALTABLE_H
+#define CALTABLE_H
+
+#include <Arduino.h>
+#include <EEPROM.h>
+#include "Config.h"
+
+// ---------------- Multi-point calibration table ----------------
+// ADC values captured at CAL_POINTS reference angles (point i at i * 360° / (CAL_POINTS-1)),
+// strictly increasing. While a complete table is stored it replaces the two-point
+// calMin/calMax line in adcToAngle100() (Sensor.cpp builds the lookup from it).
+//
+// Stored with a record header like the settings journal (magic, version, length, CRC-16
+// over header and points). Version 1 tables (4-byte header with an XOR check) are read
+// once and written again in the current format.
+static const int CAL_TABLE_EEPROM_ADDR = 16;  // Settings occupy 0..7
+static const uint16_t CAL_TABLE_MAGIC = 0x5443;  // "CT" in EEPROM byte order
+static const uint8_t CAL_TABLE_VERSION = 2;
+
+// 8-byte header first: no padding before adc[], same layout on every target
+struct CalTable {
+  uint16_t magic;            // CAL_TABLE_MAGIC
+  uint8_t  version;          // CAL_TABLE_VERSION
+  uint8_t  length;           // Bytes of adc[] (2 * CAL_POINTS at the time it was saved)
+  uint8_t  extraBits;        // ADC_EXTRA_BITS of adc[]
+  uint8_t  reserved;         // 0
+  uint16_t crc;              // CRC-16 of the header bytes before crc, then adc[]
+  uint16_t adc[CAL_POINTS];  // ADC value at each reference angle
+};
+
+// Result of calTableCapture()
+enum CalCaptureResult : uint8_t {
+  CAL_CAPTURED = 0,   // Stored in RAM, more points needed
+  CAL_SAVED,          // Table complete and valid: saved to EEPROM and in use
+  CAL_NOT_MONOTONIC,  // Table complete but ADC values not increasing: not saved
+};
+
+// Read the table from EEPROM (call before sensorCalRebuild(); loadSettings() does)
+void calTableLoad();
+
+// True while a complete, valid table is in use
+bool calTableActive();
+
+// Reference angle of point i (centidegrees, 36000 for the last point)
+uint16_t calTableAngle100(uint8_t i);
+
+// ADC value of point i and whether it is known (loaded or captured)
+uint16_t calTableAdc(uint8_t i);
+bool calTableHasPoint(uint8_t i);
+
+// Store the ADC value of point i; once all points are known and increasing, the table
+// is saved and activated (re-capturing a point of an active table saves at once)
+CalCaptureResult calTableCapture(uint8_t i, uint16_t adc);
+
+// Forget all points and fall back to the two-point calibration
+void calTableClear();
+
+#endif // CALTABLE_H
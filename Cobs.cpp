@@ -0,0 +1,36 @@
+#include "Cobs.h"
+
+uint16_t cobsEncode(const uint8_t* src, uint16_t len, uint8_t* dst) {
+  uint16_t out = 1;   // dst[code] is filled in when its block ends
+  uint16_t code = 0;
+  uint8_t run = 1;    // Code value: bytes in the block + 1
+  for (uint16_t i = 0; i < len; i++) {
+    if (src[i] != 0) {
+      dst[out++] = src[i];
+      run++;
+    }
+    if (src[i] == 0 || run == 0xFF) {
+      dst[code] = run;
+      code = out++;
+      run = 1;
+    }
+  }
+  dst[code] = run;
+  return out;
+}
+
+int16_t cobsDecode(const uint8_t* src, uint16_t len, uint8_t* dst) {
+  uint16_t in = 0;
+  uint16_t out = 0;
+  while (in < len) {
+    uint8_t code = src[in++];
+    if (code == 0 || in + code - 1 > len) return -1;
+    for (uint8_t i = 1; i < code; i++) {
+      if (src[in] == 0) return -1;
+      dst[out++] = src[in++];
+    }
+    // A full block (0xFF) has no implied zero; neither does the last block
+    if (code != 0xFF && in < len) dst[out++] = 0;
+  }
+  return (int16_t)out;
+}
@@ -0,0 +1,23 @@
+#ifndef COBS_H
+#define COBS_H
+
+#include <Arduino.h>
+
+// ---------------- COBS framing ----------------
+// Consistent Overhead Byte Stuffing: removes every 0x00 from a packet at a cost of one
+// byte per 254 (plus one), so 0x00 can delimit frames on a byte stream. A receiver
+// that starts mid-stream or loses bytes resynchronizes at the next 0x00.
+
+// Encoded size of len bytes (without the 0x00 delimiter)
+#define COBS_MAX_ENCODED(len) ((len) + (len) / 254 + 1)
+
+// Encode len bytes from src into dst (COBS_MAX_ENCODED(len) bytes); returns the
+// encoded length. dst contains no 0x00; the caller appends the delimiter.
+uint16_t cobsEncode(const uint8_t* src, uint16_t len, uint8_t* dst);
+
+// Decode one frame (without the delimiter) from src into dst (len - 1 bytes suffice);
+// returns the decoded length, or -1 if the frame is malformed (contains 0x00 or ends
+// inside a block)
+int16_t cobsDecode(const uint8_t* src, uint16_t len, uint8_t* dst);
+
+#endif // COBS_H
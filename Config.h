@@ -15,12 +15,17 @@
 
 // ---------------- LCD Configuration ----------------
 // Choose LCD type: 1602 (16x2) or 2004 (20x4)
-#define LCD_TYPE_1602
-// #define LCD_TYPE_2004
+// (the guards let a build system such as the host build pass its own choice with -D)
+#if !defined(LCD_TYPE_1602) && !defined(LCD_TYPE_2004)
+  #define LCD_TYPE_1602
+  // #define LCD_TYPE_2004
+#endif
 
 // Choose interface: I2C or PARALLEL_4BIT
-// #define LCD_INTERFACE_I2C
-#define LCD_INTERFACE_PARALLEL_4BIT
+#if !defined(LCD_INTERFACE_I2C) && !defined(LCD_INTERFACE_PARALLEL_4BIT)
+  // #define LCD_INTERFACE_I2C
+  #define LCD_INTERFACE_PARALLEL_4BIT
+#endif
 
 #if defined(LCD_TYPE_1602)
   #define LCD_COLS 16
@@ -33,7 +38,26 @@
 #endif
 
 // I2C address for I2C interface
-//#define LCD_I2C_ADDR 0x27  // Change to 0x3F if needed
+#ifndef LCD_I2C_ADDR
+  #define LCD_I2C_ADDR 0x27  // Change to 0x3F if needed
+#endif
+
+// I2C only: use the in-project batched PCF8574 driver (LcdI2cBatched) instead of
+// LiquidCrystal_I2C. It packs up to LCD_I2C_BATCH_BYTES expander states into one Wire
+// transaction (a character costs 4 bytes, so ~8 characters per transaction).
+// #define LCD_I2C_BATCHED
+#define LCD_I2C_CLOCK 100000UL   // Bus clock for LcdI2cBatched: 100000 or 400000 (fast mode)
+#define LCD_I2C_BATCH_BYTES 32   // Max bytes per transaction (<= Wire buffer: 32 on AVR)
+
+// 4-bit parallel only: drive the LCD through the in-project direct port-register
+// driver (LcdParallelDirect) instead of the LiquidCrystal library (~5x faster per byte).
+// Supported on ATmega328P and ATmega32U4 (LCD pins must be D0..D13).
+// #define LCD_PARALLEL_DIRECT_IO
+
+#include "FastPin.h"
+#if defined(LCD_PARALLEL_DIRECT_IO) && !defined(FASTPIN_SUPPORTED)
+  #undef LCD_PARALLEL_DIRECT_IO  // No pin-to-port table for this board: fall back to LiquidCrystal
+#endif
 
 // Pin definitions for 4-bit parallel interface
 #define PIN_LCD_RS 12
@@ -52,11 +76,119 @@ static const uint8_t PIN_BTN_DOWN = 3;   // Button DOWN (move menu down)
 static const uint8_t PIN_BTN_OK   = 4;   // Button OK (select/confirm)
 static const uint8_t PIN_BTN_BACK = 9;   // Button BACK (cancel/back) - D5 занят LCD, використано D9
 
+// Capture button edges with pin-change interrupts (timestamped queue, debounced later in
+// loop()), so presses are not missed or delayed while loop() is busy. ATmega328P only;
+// other boards feed the same queue by sampling every BUTTON_TICK_MS.
+// Comment out to debounce by polling (vertical counters).
+#define BUTTON_PCINT
+
 static const uint8_t PIN_ANGLE  = A0;  // Analog input for P3022 sensor
 
+// ---------------- ADC Sampling ----------------
+// The ADC runs in free-running mode in the background; the ADC-complete ISR sums
+// blocks of 2^ADC_AVG_SHIFT conversions and loop() only picks up the last finished block.
+// Sample rate is independent of UI_TICK_MS: ADC clock = F_CPU / 2^ADC_PRESCALER_BITS,
+// one conversion = 13 ADC clocks.
+//   16 MHz, /128 -> 125 kHz ADC clock -> ~9615 samples/s -> ~150 averaged values/s (64 samples)
+#ifndef ADC_AVG_SHIFT_CFG
+  #define ADC_AVG_SHIFT_CFG 6                  // Build flags may override (host tests: 8)
+#endif
+static const uint8_t ADC_AVG_SHIFT = ADC_AVG_SHIFT_CFG;  // 2^6 = 64 samples per averaged value (max 8)
+static const uint8_t ADC_PRESCALER_BITS = 7;   // ADPS2:0 value: 7 = /128 (keep ADC clock 50..200 kHz)
+// Time per averaged value (6656 us at 16 MHz, /128, 64 samples)
+static const uint32_t ADC_BLOCK_US = (13UL << ADC_PRESCALER_BITS) * (1UL << ADC_AVG_SHIFT) / (F_CPU / 1000000UL);
+
+// Oversampling and decimation: each extra bit of resolution costs 4x the samples, so a
+// block of 2^ADC_AVG_SHIFT samples is summed and shifted right by only
+// (ADC_AVG_SHIFT - ADC_EXTRA_BITS). Needs >= 1 LSB of noise on the input (the P3022
+// output and the ADC itself normally provide it).
+//   0 = plain 10-bit average (0..1023), 2 = 12-bit (0..4095), 3 = 13-bit (0..8191),
+//   4 = 14-bit (0..16383, needs ADC_AVG_SHIFT = 8)
+// Calibration values are stored with their resolution and rescaled when it changes
+// (adcRescale() in Sensor.h).
+#ifndef ADC_EXTRA_BITS_CFG
+  #define ADC_EXTRA_BITS_CFG 2                 // Build flags may override (host tests: 4)
+#endif
+static const uint8_t ADC_EXTRA_BITS = ADC_EXTRA_BITS_CFG;
+static const uint8_t ADC_BITS = 10 + ADC_EXTRA_BITS;
+static const uint16_t ADC_MAX = (1U << ADC_BITS) - 1;
+// Highest value the averaging can produce (every reading 1023): the reachable full scale
+static const uint16_t ADC_FULL_SCALE = 1023U << ADC_EXTRA_BITS;
+static_assert(ADC_EXTRA_BITS <= 4 && ADC_EXTRA_BITS * 2 <= ADC_AVG_SHIFT,
+              "ADC_EXTRA_BITS needs 4^ADC_EXTRA_BITS samples per block (max 14-bit)");
+
+// Idle-sleep between loop() passes while the LCD queue is empty (comment out to busy-poll):
+// the CPU core clock stops, which keeps its switching noise out of running conversions
+// (timers, ADC and pin-change interrupts keep running and wake the CPU)
+#define ADC_IDLE_SLEEP
+
+// ---------------- Calibration Table ----------------
+// Optional multi-point calibration (menu "Cal Table", stored in EEPROM): ADC values at
+// CAL_POINTS equally spaced angles from 0° to 360° (17 points = every 22.5°).
+// Conversion finds the segment through an index on the top CAL_LUT_BITS of the ADC
+// value and uses a precomputed slope, so adcToAngle100() stays O(1): one lookup, one multiply.
+static const uint8_t CAL_POINTS = 17;    // 3..65 (RAM: 6 bytes per segment + 2 per point)
+static const uint8_t CAL_LUT_BITS = 6;   // 64-entry segment index (64 bytes RAM), 1..8
+static_assert(CAL_POINTS >= 3 && CAL_POINTS <= 65, "CAL_POINTS: 3..65");
+static_assert(CAL_LUT_BITS >= 1 && CAL_LUT_BITS <= 8, "CAL_LUT_BITS: 1..8");
+
+// ---------------- EEPROM Writes ----------------
+// Settings and the calibration table are written in the background by the EE_READY
+// interrupt (EepromWriter.h), one byte per ~3.4 ms, while loop() keeps running.
+static const uint8_t EEPROM_WRITER_JOBS = 4;    // Queued writes before eepromWriterWrite() waits
+static const uint16_t EEPROM_WRITE_US = 3400;   // Erase + write time of one byte (datasheet: 3.4 ms)
+
+// Power-fail input (optional): LOW while the supply is about to drop, e.g. from a voltage
+// supervisor on the unregulated input. Pending settings are then written at once; the
+// hold-up capacitance must keep VCC up for ~55 ms (one 16-byte settings record).
+// Also enable the brown-out detector (BODLEVEL fuse, 2.7 V on Uno/Nano): below its level
+// the CPU is held in reset, so no EEPROM write starts at a voltage that could corrupt it.
+// A write cut short by power loss fails its crc and the previous settings are used.
+// #define POWER_FAIL_PIN A1
+
+// ---------------- Display Filter ----------------
+// MAIN screen angle filter (AngleFilter.h), fed with every averaged ADC value (~150/s)
+// in this order: median -> alpha-beta tracker -> hysteresis -> zero snap.
+// The tracker's velocity gains follow from the alphas (critically damped).
+static const uint8_t DISPLAY_MEDIAN_N = 3;          // Spike removal window (odd, 3..9)
+static const uint8_t DISPLAY_AB_ALPHA_REST = 8;     // Tracker gain at rest (/256): ~32 values = ~210 ms
+static const uint8_t DISPLAY_AB_ALPHA_MOVE = 96;    // Tracker gain while moving (/256): follows within a few values
+static const uint16_t DISPLAY_AB_MOVE_100 = 50;     // Prediction error that switches to the moving gains (0.50°)
+static const uint16_t DISPLAY_HYSTERESIS_100 = 10;  // Minimum change to update display (0.10°)
+static const uint16_t DISPLAY_ZERO_SNAP_100 = 20;   // Show 0.00° while within 0.20° of zero
+
 // ---------------- Timing Constants ----------------
+// Task periods (task table in the .ino, run by Scheduler.h)
 static const uint16_t BUTTON_TICK_MS = 10;   // Button processing: 10ms (debouncing and long press detection)
 static const uint16_t UI_TICK_MS = 20;       // UI update: 20ms = 50Hz (reduced from 10ms to reduce flickering)
+static const uint16_t SENSOR_TICK_MS = 2;    // Display filter: picks up each averaged ADC value within 2ms
+static const uint16_t SETTINGS_TICK_MS = 5;  // Settings commit and power-fail check
+static const uint16_t LCD_PUMP_BUDGET_US = 300;  // Max time per loop() pass spent sending queued LCD bytes
+static const uint16_t SETTINGS_COMMIT_DELAY_MS = 3000;  // Settings reach EEPROM after this long without changes
+
+// ---------------- Scheduler ----------------
+// Tasks are released by a Timer1 compare-match interrupt every SCHED_TICK_US (Timer1 PWM,
+// i.e. analogWrite() on D9/D10 on Uno/Nano, is then unavailable; nothing here uses it)
+static const uint16_t SCHED_TICK_US = 1000;
+static const uint8_t SCHED_MAX_TASKS = 8;    // Task table entries (RAM: 18 bytes each)
+
+// ---------------- Telemetry ----------------
+// Uncomment to stream the sensor values as binary frames on Serial (Telemetry.h,
+// decoder: host/telemetry). 250000 baud is exact at 16 MHz; a 22-byte frame every
+// 10 ms uses ~9% of it. Shares Serial with the profiler, so only one of the two.
+// #define TELEMETRY
+static const uint32_t TELEMETRY_BAUD = 250000;
+static const uint16_t TELEMETRY_PERIOD_MS = 10;  // Frame rate: 100/s
+
+// ---------------- Profiling ----------------
+// Uncomment to time every loop() stage with micros() (min/max/mean + log2 histogram).
+// Over Serial (PROFILER_BAUD): 'p' prints the report, 'r' resets the statistics.
+// #define LOOP_PROFILER
+static const uint32_t PROFILER_BAUD = 115200;
+
+#if defined(TELEMETRY) && defined(LOOP_PROFILER)
+  #error "TELEMETRY and LOOP_PROFILER both use Serial: enable only one"
+#endif
 
 // Note: Encoder functionality removed in Button_V1.1 branch - replaced with button navigation
 
@@ -0,0 +1,26 @@
+#include "Crc16.h"
+
+// Table entry for byte b: the CRC register after shifting b through 8 times,
+// evaluated by the compiler
+static constexpr uint16_t crcStep(uint16_t c, uint8_t bits) {
+  return bits == 0 ? c : crcStep((c & 0x8000) ? (uint16_t)((c << 1) ^ 0x1021) : (uint16_t)(c << 1), bits - 1);
+}
+#define CRC_E(b) crcStep((uint16_t)((b) << 8), 8)
+#define CRC_4(b) CRC_E(b), CRC_E((b) + 1), CRC_E((b) + 2), CRC_E((b) + 3)
+#define CRC_16(b) CRC_4(b), CRC_4((b) + 4), CRC_4((b) + 8), CRC_4((b) + 12)
+#define CRC_64(b) CRC_16(b), CRC_16((b) + 16), CRC_16((b) + 32), CRC_16((b) + 48)
+static const uint16_t CRC16_TABLE[256] PROGMEM = {
+  CRC_64(0), CRC_64(64), CRC_64(128), CRC_64(192)
+};
+#undef CRC_64
+#undef CRC_16
+#undef CRC_4
+#undef CRC_E
+
+uint16_t crc16(const void* data, uint16_t len, uint16_t crc) {
+  const uint8_t* p = (const uint8_t*)data;
+  while (len--) {
+    crc = (uint16_t)(crc << 8) ^ pgm_read_word(&CRC16_TABLE[(uint8_t)(crc >> 8) ^ *p++]);
+  }
+  return crc;
+}
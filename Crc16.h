@@ -0,0 +1,16 @@
+#ifndef CRC16_H
+#define CRC16_H
+
+#include <Arduino.h>
+
+// ---------------- CRC-16 ----------------
+// CRC-16/CCITT-FALSE: polynomial 0x1021, initial value 0xFFFF, no reflection
+// ("123456789" -> 0x29B1). Detects all 1- to 3-bit errors and bursts up to 16 bits in
+// short records, which an XOR checksum misses as soon as two bit flips line up.
+// One table lookup per byte (256-entry table in flash, 512 bytes).
+static const uint16_t CRC16_INIT = 0xFFFF;
+
+// CRC of len bytes; pass a previous result as crc to continue over several buffers
+uint16_t crc16(const void* data, uint16_t len, uint16_t crc = CRC16_INIT);
+
+#endif // CRC16_H
@@ -0,0 +1,115 @@
+#include "EepromWriter.h"
+#include <EEPROM.h>
+
+struct EepromJob {
+  uint16_t addr;
+  const uint8_t* src;
+  uint8_t len;
+};
+
+// Ring of queued jobs: added by loop(), removed by the EE_READY ISR (AVR)
+static EepromJob jobs_[EEPROM_WRITER_JOBS];
+static volatile uint8_t first_ = 0;  // Job being written
+static volatile uint8_t count_ = 0;  // Jobs queued, including the one being written
+static uint8_t pos_ = 0;             // Next byte of the first job
+
+#if defined(__AVR__)
+static inline uint8_t readCell(uint16_t addr) {
+  EEAR = addr;
+  EECR |= (1 << EERE);
+  return EEDR;
+}
+#else
+static inline uint8_t readCell(uint16_t addr) {
+  return EEPROM.read(addr);
+}
+#endif
+
+// Next queued byte that differs from the EEPROM (finished jobs are dropped);
+// false when the queue is empty. Only call while no byte write is in progress.
+static bool nextChange(uint16_t& addr, uint8_t& value) {
+  while (count_) {
+    const EepromJob& j = jobs_[first_];
+    while (pos_ < j.len) {
+      addr = j.addr + pos_;
+      value = j.src[pos_++];
+      if (readCell(addr) != value) return true;
+    }
+    pos_ = 0;
+    first_ = (first_ + 1 < EEPROM_WRITER_JOBS) ? first_ + 1 : 0;
+    count_--;
+  }
+  return false;
+}
+
+#if defined(__AVR__)
+// EEPROM ready (EEPE clear): start the next byte, or stop interrupting when done
+ISR(EE_READY_vect) {
+  uint16_t addr;
+  uint8_t value;
+  if (nextChange(addr, value)) {
+    EEAR = addr;
+    EEDR = value;
+    EECR |= (1 << EEMPE);  // EEPE must follow within 4 cycles (interrupts are off here)
+    EECR |= (1 << EEPE);   // Erase + write (EEPM = 0), ~3.4 ms
+  } else {
+    EECR &= ~(1 << EERIE);
+  }
+}
+
+static void kick() {
+  EECR |= (1 << EERIE);  // Fires at once if no write is in progress
+}
+
+static void waitByte() {
+}
+
+void eepromWriterPoll() {
+}
+#else
+static uint32_t lastWriteUs_ = 0;
+static bool writing_ = false;  // A byte was written less than EEPROM_WRITE_US ago
+
+static void kick() {
+}
+
+// Wait out the byte in progress, then start the next one
+static void waitByte() {
+  uint32_t elapsed = micros() - lastWriteUs_;
+  if (writing_ && elapsed < EEPROM_WRITE_US) delayMicroseconds(EEPROM_WRITE_US - elapsed);
+  eepromWriterPoll();
+}
+
+void eepromWriterPoll() {
+  if (writing_ && (uint32_t)(micros() - lastWriteUs_) < EEPROM_WRITE_US) return;
+  writing_ = false;
+  uint16_t addr;
+  uint8_t value;
+  if (nextChange(addr, value)) {
+    EEPROM.write(addr, value);
+    lastWriteUs_ = micros();
+    writing_ = true;
+  }
+}
+#endif
+
+void eepromWriterWrite(int addr, const void* src, uint8_t len) {
+  while (count_ >= EEPROM_WRITER_JOBS) waitByte();  // Full: wait for the oldest job
+  noInterrupts();
+  uint8_t i = first_ + count_;
+  if (i >= EEPROM_WRITER_JOBS) i -= EEPROM_WRITER_JOBS;
+  jobs_[i].addr = (uint16_t)addr;
+  jobs_[i].src = (const uint8_t*)src;
+  jobs_[i].len = len;
+  count_++;
+  interrupts();
+  kick();
+}
+
+bool eepromWriterBusy() {
+  return count_ != 0;  // A job is dropped only once its last byte has been written
+}
+
+void eepromWriterFlush() {
+  while (eepromWriterBusy()) waitByte();
+}
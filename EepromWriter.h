@@ -0,0 +1,32 @@
+#ifndef EEPROMWRITER_H
+#define EEPROMWRITER_H
+
+#include <Arduino.h>
+#include "Config.h"
+
+// ---------------- Background EEPROM writer ----------------
+// An EEPROM byte takes ~3.4 ms to erase and write; EEPROM.put() busy-waits for each one.
+// Here a write is queued as a job (address + source buffer) and the EE_READY interrupt
+// writes one byte per interrupt, so loop() never waits for the EEPROM. Like
+// EEPROM.update(), bytes that already hold the value are skipped.
+// Boards without the AVR EEPROM registers write one byte per EEPROM_WRITE_US from
+// eepromWriterPoll() instead.
+//
+// The source buffer is read while the job runs: it must stay valid, and should not
+// change, until eepromWriterBusy() is false. Do not read the EEPROM (EEPROM.get)
+// while the writer is busy - call eepromWriterFlush() first.
+
+// Queue len bytes from src for address addr. Returns at once unless
+// EEPROM_WRITER_JOBS jobs are already queued (then waits for the oldest to finish).
+void eepromWriterWrite(int addr, const void* src, uint8_t len);
+
+// True while queued bytes are not yet written
+bool eepromWriterBusy();
+
+// Block until every queued byte is written (power fail, before reading the EEPROM)
+void eepromWriterFlush();
+
+// Call from loop(): drives the writer where there is no EE_READY interrupt (no-op on AVR)
+void eepromWriterPoll();
+
+#endif // EEPROMWRITER_H
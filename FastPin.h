@@ -0,0 +1,53 @@
+#ifndef FASTPIN_H
+#define FASTPIN_H
+
+#include <Arduino.h>
+
+// ---------------- Compile-time pin -> port register mapping ----------------
+// Arduino pin numbers resolved to PORTx address + bit mask at compile time, so a pin
+// access with a constant pin is a single sbi/cbi/sbis instead of a digitalWrite() /
+// digitalRead() table walk. Only for boards with a table below (FASTPIN_SUPPORTED).
+#if defined(__AVR_ATmega328P__) || defined(__AVR_ATmega328__) || defined(__AVR_ATmega32U4__)
+#define FASTPIN_SUPPORTED
+
+namespace fastpin {
+
+// Arduino digital pin -> data-space address of its PORTx register / bit number
+// PORTB = 0x25, PORTC = 0x28, PORTD = 0x2B, PORTE = 0x2E (DDRx = PORTx - 1, PINx = PORTx - 2)
+#if defined(__AVR_ATmega32U4__)
+  //                              D0    D1    D2    D3    D4    D5    D6    D7    D8    D9    D10   D11   D12   D13
+  constexpr uint8_t PORT_ADDR[] = { 0x2B, 0x2B, 0x2B, 0x2B, 0x2B, 0x28, 0x2B, 0x2E, 0x25, 0x25, 0x25, 0x25, 0x2B, 0x28 };
+  constexpr uint8_t PORT_BIT[]  = { 2,    3,    1,    0,    4,    6,    7,    6,    4,    5,    6,    7,    6,    7    };
+#else  // ATmega328P: D0..D7 = PORTD, D8..D13 = PORTB
+  constexpr uint8_t PORT_ADDR[] = { 0x2B, 0x2B, 0x2B, 0x2B, 0x2B, 0x2B, 0x2B, 0x2B, 0x25, 0x25, 0x25, 0x25, 0x25, 0x25 };
+  constexpr uint8_t PORT_BIT[]  = { 0,    1,    2,    3,    4,    5,    6,    7,    0,    1,    2,    3,    4,    5    };
+#endif
+
+constexpr uint8_t PIN_COUNT = sizeof(PORT_ADDR);
+
+constexpr uint8_t portAddr(uint8_t pin) { return PORT_ADDR[pin]; }
+constexpr uint8_t pinMask(uint8_t pin) { return (uint8_t)(1 << PORT_BIT[pin]); }
+
+inline volatile uint8_t& portReg(uint8_t addr) { return *(volatile uint8_t*)(uint16_t)addr; }
+inline volatile uint8_t& ddrReg(uint8_t addr)  { return *(volatile uint8_t*)(uint16_t)(addr - 1); }
+inline volatile uint8_t& pinReg(uint8_t addr)  { return *(volatile uint8_t*)(uint16_t)(addr - 2); }
+
+// Set or clear one pin; with a constant PIN this compiles to a single sbi/cbi
+template <uint8_t PIN>
+inline void pinWrite(bool high) {
+  static_assert(PIN < PIN_COUNT, "pin must be D0..D13");
+  if (high) portReg(portAddr(PIN)) |= pinMask(PIN);
+  else portReg(portAddr(PIN)) &= (uint8_t)~pinMask(PIN);
+}
+
+template <uint8_t PIN>
+inline void pinOutput() {
+  static_assert(PIN < PIN_COUNT, "pin must be D0..D13");
+  ddrReg(portAddr(PIN)) |= pinMask(PIN);
+}
+
+} // namespace fastpin
+
+#endif // board with pin table
+
+#endif // FASTPIN_H
@@ -0,0 +1,64 @@
+#ifndef INPUTEVENT_H
+#define INPUTEVENT_H
+
+#include <Arduino.h>
+
+// ---------------- Input events ----------------
+// One button gesture, produced by ButtonBank::emitEvents() and consumed by MenuManager
+struct InputEvent {
+  enum Gesture : uint8_t {
+    EV_CLICK = 0,      // Released before the long press threshold (and without auto-repeat)
+    EV_LONG,           // Held for the long press threshold (fires once, button still down)
+    EV_LONG_RELEASE,   // Released after EV_LONG
+    EV_REPEAT          // Auto-repeat while held (UP/DOWN)
+  };
+
+  uint8_t button;   // ButtonBank::ButtonId
+  uint8_t gesture;  // Gesture
+  uint16_t ms;      // Low 16 bits of millis() when the gesture was recognised
+
+  // Full millis() timestamp, given the current millis() (events are younger than 65 s)
+  uint32_t fullMs(uint32_t nowMs) const { return nowMs - (uint16_t)((uint16_t)nowMs - ms); }
+};
+
+// Fixed-capacity FIFO of input events (single loop() context, no ISR access)
+class InputQueue {
+public:
+  static const uint8_t CAPACITY = 8;
+
+  InputQueue() : head_(0), count_(0), dropped_(0) {}
+
+  // False (event dropped) when full
+  bool push(uint8_t button, uint8_t gesture, uint16_t ms) {
+    if (count_ >= CAPACITY) {
+      if (dropped_ != 0xFF) dropped_++;
+      return false;
+    }
+    InputEvent& e = events_[(uint8_t)(head_ + count_) % CAPACITY];
+    e.button = button;
+    e.gesture = gesture;
+    e.ms = ms;
+    count_++;
+    return true;
+  }
+
+  bool pop(InputEvent& e) {
+    if (count_ == 0) return false;
+    e = events_[head_];
+    head_ = (uint8_t)(head_ + 1) % CAPACITY;
+    count_--;
+    return true;
+  }
+
+  bool empty() const { return count_ == 0; }
+  void clear() { head_ = 0; count_ = 0; }
+  uint8_t getDropped() const { return dropped_; }
+
+private:
+  InputEvent events_[CAPACITY];
+  uint8_t head_;
+  uint8_t count_;
+  uint8_t dropped_;
+};
+
+#endif // INPUTEVENT_H
@@ -1,11 +1,10 @@
 #include "LCDDisplay.h"
+#include "Profiler.h"
 #include <Wire.h>  // For I2C interface
 
-#if defined(LCD_INTERFACE_I2C)
-LCDDisplay::LCDDisplay(LiquidCrystal_I2C& lcdRef) : initialized_(false), lineSize_(LCD_COLS + 1), lcd(lcdRef) {
-#elif defined(LCD_INTERFACE_PARALLEL_4BIT)
-LCDDisplay::LCDDisplay(LiquidCrystal& lcdRef) : initialized_(false), lineSize_(LCD_COLS + 1), lcd(lcdRef) {
-#endif
+LCDDisplay::LCDDisplay(LcdDriver& lcdRef) : initialized_(false), lineSize_(LCD_COLS + 1),
+    lastFlushBytes_(0), totalBytes_(0), coalescedFrames_(0),
+    spanCount_(0), spanIdx_(0), spanCol_(0), cursorPlaced_(false), lcd(lcdRef) {
   // Allocate static buffers for all rows
   // Using static allocation instead of dynamic to avoid memory fragmentation
 }
@@ -65,6 +64,9 @@ void LCDDisplay::showStartup() {
     lcd.setCursor(0, 3);
     lcd.print("Ready...");
   #endif
+  #if defined(LCD_I2C_BATCHED)
+    lcd.sync();
+  #endif
   delay(5000);
   
   // Clear and show ready message
@@ -75,7 +77,7 @@ void LCDDisplay::showStartup() {
     setLine(2, "Long: Set Zero");
     setLine(3, "");
   #endif
-  flush();
+  flushNow();
   delay(300);
 }
 
@@ -97,34 +99,106 @@ void LCDDisplay::setLine(uint8_t row, const char* s) {
   dst[LCD_COLS] = 0;
 }
 
+LineWriter LCDDisplay::line(uint8_t row) {
+  if (row >= LCD_ROWS) row = LCD_ROWS - 1;
+  return LineWriter(lines_[row], LCD_COLS);
+}
+
 void LCDDisplay::flush() {
   if (!initialized_) return;
   
-  // Update only changed lines for better performance
+  // A newer frame replaces whatever is still pending: spans are rebuilt against
+  // the glass contents, so half-sent spans are simply diffed again
+  if (!isIdle() && coalescedFrames_ != 0xFFFF) coalescedFrames_++;
+  spanCount_ = 0;
+  spanIdx_ = 0;
+  cursorPlaced_ = false;
+  
+  uint16_t queued = 0;
   for (uint8_t row = 0; row < LCD_ROWS; row++) {
-    if (strcmp(prevLines_[row], lines_[row]) != 0) {
-      lcd.setCursor(0, row);
-      lcd.print(lines_[row]);
-      memcpy(prevLines_[row], lines_[row], lineSize_);
+    const char* cur = lines_[row];
+    const char* prev = prevLines_[row];
+    if (cur[0] == 0) continue;  // Row never set since clear()
+    
+    uint8_t col = 0;
+    while (col < LCD_COLS) {
+      if (cur[col] == prev[col]) {
+        col++;
+        continue;
+      }
+      
+      // Extend the span over further changes that are at most FLUSH_MERGE_GAP chars apart
+      uint8_t start = col;
+      uint8_t end = col + 1;
+      for (uint8_t i = end; i < LCD_COLS && (uint8_t)(i - end) <= FLUSH_MERGE_GAP; i++) {
+        if (cur[i] != prev[i]) end = i + 1;
+      }
+      
+      FlushSpan& sp = spans_[spanCount_++];
+      sp.row = row;
+      sp.start = start;
+      sp.end = end;
+      queued += 1 + (end - start);
+      col = end;
     }
   }
+  
+  lastFlushBytes_ = queued;
+}
+
+void LCDDisplay::pump(uint16_t budgetUs) {
+  if (isIdle()) return;
+  
+  uint32_t t0 = micros();
+  uint16_t sent = 0;
+  do {
+    const FlushSpan& sp = spans_[spanIdx_];
+    if (!cursorPlaced_) {
+      lcd.setCursor(sp.start, sp.row);
+      cursorPlaced_ = true;
+      spanCol_ = sp.start;
+    } else {
+      char c = lines_[sp.row][spanCol_];
+      lcd.write((uint8_t)c);
+      prevLines_[sp.row][spanCol_] = c;
+      if (++spanCol_ >= sp.end) {
+        spanIdx_++;
+        cursorPlaced_ = false;
+      }
+    }
+    totalBytes_++;
+    sent++;
+    #if defined(LCD_I2C_BATCHED)
+      // Buffered bytes cost nothing until sync(), so charge their bus time up front
+      if ((uint32_t)(micros() - t0) + lcd.pendingMicros() >= budgetUs) break;
+    #endif
+  } while (!isIdle() && (uint32_t)(micros() - t0) < budgetUs);
+  #if defined(LCD_I2C_BATCHED)
+    lcd.sync();  // Send the bytes still buffered in the open Wire transmission
+  #endif
+  
+  #if defined(LOOP_PROFILER)
+    profilerRecord(PROF_LCD_BYTE, (micros() - t0) / sent);  // Backend speed: us per byte
+  #endif
+}
+
+void LCDDisplay::flushNow() {
+  flush();
+  while (!isIdle()) pump(0xFFFF);
 }
 
 void LCDDisplay::clear() {
   if (!initialized_) return;
   lcd.clear();
+  spanCount_ = 0;
+  spanIdx_ = 0;
+  cursorPlaced_ = false;
   for (uint8_t i = 0; i < LCD_ROWS; i++) {
     memset(lines_[i], 0, lineSize_);
     memset(prevLines_[i], 0, lineSize_);
   }
 }
 
-#if defined(LCD_INTERFACE_I2C)
-LiquidCrystal_I2C& LCDDisplay::getLCD() {
-  return lcd;
-}
-#elif defined(LCD_INTERFACE_PARALLEL_4BIT)
-LiquidCrystal& LCDDisplay::getLCD() {
+LcdDriver& LCDDisplay::getLCD() {
   return lcd;
 }
-#endif
@@ -4,26 +4,35 @@
 #include <Arduino.h>
 #include <string.h>
 #include "Config.h"
+#include "Utils.h"
 
-#if defined(LCD_INTERFACE_I2C)
+// LCD driver type selected by Config.h
+#if defined(LCD_INTERFACE_I2C) && defined(LCD_I2C_BATCHED)
+  #include "LcdI2cBatched.h"
+  typedef LcdI2cBatched LcdDriver;
+  #define LCD_BACKEND_NAME "batched I2C"
+#elif defined(LCD_INTERFACE_I2C)
   #include <LiquidCrystal_I2C.h>
-  // Forward declaration - global lcd object will be defined in main .ino
-  extern LiquidCrystal_I2C lcd;
+  typedef LiquidCrystal_I2C LcdDriver;
+  #define LCD_BACKEND_NAME "LiquidCrystal_I2C"
+#elif defined(LCD_INTERFACE_PARALLEL_4BIT) && defined(LCD_PARALLEL_DIRECT_IO)
+  #include "LcdParallelDirect.h"
+  typedef LcdParallelDirect LcdDriver;
+  #define LCD_BACKEND_NAME "direct port I/O"
 #elif defined(LCD_INTERFACE_PARALLEL_4BIT)
   #include <LiquidCrystal.h>
-  // Forward declaration - global lcd object will be defined in main .ino
-  extern LiquidCrystal lcd;
+  typedef LiquidCrystal LcdDriver;
+  #define LCD_BACKEND_NAME "LiquidCrystal"
 #endif
 
+// Forward declaration - global lcd object will be defined in main .ino
+extern LcdDriver lcd;
+
 // ---------------- LCD Display Class ----------------
 class LCDDisplay {
 public:
   // Constructor - takes reference to global LCD object
-  #if defined(LCD_INTERFACE_I2C)
-    LCDDisplay(LiquidCrystal_I2C& lcdRef);
-  #elif defined(LCD_INTERFACE_PARALLEL_4BIT)
-    LCDDisplay(LiquidCrystal& lcdRef);
-  #endif
+  LCDDisplay(LcdDriver& lcdRef);
 
   // Initialize LCD display
   void begin();
@@ -34,24 +43,62 @@ public:
   // Set line text (buffered, doesn't update display immediately)
   void setLine(uint8_t row, const char* s);
 
-  // Update display with buffered lines (minimal redraw)
+  // Blank the line buffer of row and return a writer over it (formats in place, no copy)
+  LineWriter line(uint8_t row);
+
+  // Queue the changed column spans of each row for output (minimal redraw, non-blocking)
+  // A frame still pending from an earlier flush() is replaced, never sent twice
   void flush();
 
+  // Send queued cursor/data operations until budgetUs has elapsed (at least one
+  // operation per call). Call from loop() as often as possible.
+  void pump(uint16_t budgetUs);
+
+  // Queue and send everything immediately (blocking; startup screens only)
+  void flushNow();
+
+  // True when no LCD operations are pending
+  bool isIdle() const { return spanIdx_ >= spanCount_; }
+
   // Clear display and buffers
   void clear();
 
+  // Bytes for the LCD controller (commands + characters)
+  uint16_t getLastFlushBytes() const { return lastFlushBytes_; }    // Queued by the last flush()
+  uint32_t getTotalBytes() const { return totalBytes_; }            // Sent since begin()
+  uint16_t getCoalescedFrames() const { return coalescedFrames_; }  // Frames replaced before done
+
   // Get LCD object reference for direct access if needed
-  #if defined(LCD_INTERFACE_I2C)
-    LiquidCrystal_I2C& getLCD();
-  #elif defined(LCD_INTERFACE_PARALLEL_4BIT)
-    LiquidCrystal& getLCD();
-  #endif
+  LcdDriver& getLCD();
 
 private:
   bool initialized_;
   uint8_t lineSize_;
+  uint16_t lastFlushBytes_;
+  uint32_t totalBytes_;
+
+  uint16_t coalescedFrames_;
+
+  // Unchanged characters between two changed spans that are rewritten instead of
+  // issuing another setCursor (a cursor move costs one command byte)
+  static const uint8_t FLUSH_MERGE_GAP = 1;
+
+  // Output queue: changed spans of lines_, sent by pump(). With FLUSH_MERGE_GAP = 1
+  // spans are at least 2 chars apart, so a row holds at most (LCD_COLS + 2) / 3 of them.
+  struct FlushSpan {
+    uint8_t row;
+    uint8_t start;  // First column
+    uint8_t end;    // One past the last column
+  };
+  static const uint8_t MAX_SPANS = LCD_ROWS * ((LCD_COLS + 2) / 3);
+  FlushSpan spans_[MAX_SPANS];
+  uint8_t spanCount_;
+  uint8_t spanIdx_;     // Span being sent
+  uint8_t spanCol_;     // Next column to send within the span
+  bool cursorPlaced_;   // setCursor for the current span already sent
   
   // Line buffers (static allocation)
+  // lines_ = wanted frame, prevLines_ = what is on the glass (updated as bytes go out)
   #if LCD_COLS == 16
     char lines_[LCD_ROWS][17];
     char prevLines_[LCD_ROWS][17];
@@ -61,11 +108,7 @@ private:
   #endif
   
   // Reference to global LCD object
-  #if defined(LCD_INTERFACE_I2C)
-    LiquidCrystal_I2C& lcd;
-  #elif defined(LCD_INTERFACE_PARALLEL_4BIT)
-    LiquidCrystal& lcd;
-  #endif
+  LcdDriver& lcd;
 };
 
 #endif // LCDDISPLAY_H
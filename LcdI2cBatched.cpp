@@ -0,0 +1,146 @@
+#include "LcdI2cBatched.h"
+
+#if defined(LCD_I2C_BATCHED)
+
+#include <Wire.h>
+
+// PCF8574 pin assignment
+static const uint8_t PCF_RS = 0x01;
+static const uint8_t PCF_EN = 0x04;
+static const uint8_t PCF_BL = 0x08;
+
+// HD44780 commands
+static const uint8_t LCD_CLEARDISPLAY   = 0x01;
+static const uint8_t LCD_RETURNHOME     = 0x02;
+static const uint8_t LCD_ENTRYMODESET   = 0x04;
+static const uint8_t LCD_DISPLAYCONTROL = 0x08;
+static const uint8_t LCD_FUNCTIONSET    = 0x20;
+static const uint8_t LCD_SETDDRAMADDR   = 0x80;
+
+static const uint8_t LCD_ENTRYLEFT = 0x02;  // Entry mode: increment, no shift
+static const uint8_t LCD_DISPLAYON = 0x04;  // Display on, cursor off, blink off
+static const uint8_t LCD_2LINE     = 0x08;  // 4-bit bus, 2 lines, 5x8 font
+
+static const uint16_t LCD_CLEAR_US = 2000;  // Clear / home: 1.52 ms
+
+LcdI2cBatched::LcdI2cBatched(uint8_t addr, uint8_t cols, uint8_t rows)
+  : addr_(addr), cols_(cols), rows_(rows), backlight_(PCF_BL), lastRs_(0xFF),
+    pending_(0), busBytes_(0), transactions_(0) {
+}
+
+void LcdI2cBatched::init() {
+  begin(cols_, rows_);
+}
+
+void LcdI2cBatched::begin(uint8_t cols, uint8_t rows) {
+  cols_ = cols;
+  rows_ = rows;
+  Wire.setClock(LCD_I2C_CLOCK);
+  busBytes_ = 0;
+  transactions_ = 0;
+
+  // Power-on: wait >40 ms, then force 4-bit mode with single nibbles (datasheet figure 24)
+  delay(50);
+  put(backlight_);
+  sync();
+  writeNibbleInit(0x03);
+  delayMicroseconds(4500);
+  writeNibbleInit(0x03);
+  delayMicroseconds(4500);
+  writeNibbleInit(0x03);
+  delayMicroseconds(150);
+  writeNibbleInit(0x02);
+
+  command(LCD_FUNCTIONSET | LCD_2LINE);
+  command(LCD_DISPLAYCONTROL | LCD_DISPLAYON);
+  clear();
+  command(LCD_ENTRYMODESET | LCD_ENTRYLEFT);
+  sync();
+}
+
+void LcdI2cBatched::backlight() {
+  backlight_ = PCF_BL;
+  put(backlight_ | (lastRs_ == PCF_RS ? PCF_RS : 0));
+  sync();
+}
+
+void LcdI2cBatched::noBacklight() {
+  backlight_ = 0;
+  put(lastRs_ == PCF_RS ? PCF_RS : 0);
+  sync();
+}
+
+void LcdI2cBatched::clear() {
+  command(LCD_CLEARDISPLAY);
+  sync();
+  delayMicroseconds(LCD_CLEAR_US);
+}
+
+void LcdI2cBatched::home() {
+  command(LCD_RETURNHOME);
+  sync();
+  delayMicroseconds(LCD_CLEAR_US);
+}
+
+void LcdI2cBatched::setCursor(uint8_t col, uint8_t row) {
+  // Row offsets as in LiquidCrystal: 2004 rows 2/3 continue rows 0/1 in DDRAM
+  const uint8_t offsets[4] = { 0x00, 0x40, cols_, (uint8_t)(0x40 + cols_) };
+  if (row >= 4) row = 3;
+  if (row >= rows_) row = rows_ - 1;
+  command(LCD_SETDDRAMADDR | (uint8_t)(col + offsets[row]));
+}
+
+size_t LcdI2cBatched::write(uint8_t c) {
+  send(c, PCF_RS);
+  return 1;
+}
+
+void LcdI2cBatched::command(uint8_t value) {
+  send(value, 0);
+}
+
+void LcdI2cBatched::send(uint8_t value, uint8_t rs) {
+  uint8_t hi = (value & 0xF0) | rs | backlight_;
+  uint8_t lo = (uint8_t)(value << 4) | rs | backlight_;
+
+  // One HD44780 byte = 4 expander states (5 when RS changes and must settle first);
+  // never split a byte across transmissions
+  bool rsChange = (rs != lastRs_);
+  reserve(rsChange ? 5 : 4);
+  if (rsChange) put(hi);  // RS/data setup before the enable rises
+  put(hi | PCF_EN);
+  put(hi);                // Falling edge latches the high nibble
+  put(lo | PCF_EN);
+  put(lo);                // Falling edge latches the low nibble, command starts
+  lastRs_ = rs;
+}
+
+void LcdI2cBatched::writeNibbleInit(uint8_t nibble) {
+  // 8-bit mode instruction: only D7..D4 are wired, each enable pulse is one instruction
+  uint8_t b = (uint8_t)(nibble << 4) | backlight_;
+  put(b);
+  put(b | PCF_EN);
+  put(b);
+  sync();
+  lastRs_ = 0;
+}
+
+void LcdI2cBatched::reserve(uint8_t n) {
+  if (pending_ + n > LCD_I2C_BATCH_BYTES) sync();
+}
+
+void LcdI2cBatched::put(uint8_t b) {
+  if (pending_ == 0) Wire.beginTransmission(addr_);
+  Wire.write(b);
+  pending_++;
+}
+
+void LcdI2cBatched::sync() {
+  if (pending_ == 0) return;
+  Wire.endTransmission();
+  busBytes_ += 1 + pending_;  // Address byte + payload
+  transactions_++;
+  pending_ = 0;
+}
+
+#endif // LCD_I2C_BATCHED
@@ -0,0 +1,67 @@
+#ifndef LCDI2CBATCHED_H
+#define LCDI2CBATCHED_H
+
+#include <Arduino.h>
+#include "Config.h"
+
+#if defined(LCD_I2C_BATCHED)
+
+// ---------------- Batched PCF8574 HD44780 driver ----------------
+// Drop-in for the LiquidCrystal_I2C subset used by LCDDisplay. LiquidCrystal_I2C
+// sends every expander state (nibble setup, enable high, enable low) as its own
+// Wire transaction with fixed delays. Here expander states are appended to one open
+// Wire transmission and sent when LCD_I2C_BATCH_BYTES are queued or on sync().
+// Bus time replaces the delays: even at 400 kHz an expander byte takes 22.5 us,
+// longer than any pulse/setup requirement, and two bytes cover the 37 us execution time.
+//
+// Common backpack wiring: P0=RS, P1=RW, P2=EN, P3=backlight, P4..P7=D4..D7
+class LcdI2cBatched : public Print {
+public:
+  LcdI2cBatched(uint8_t addr, uint8_t cols, uint8_t rows);
+
+  // Same as LiquidCrystal_I2C::init(): power-on init into 4-bit, 2-line mode
+  // (Wire.begin() must have been called)
+  void init();
+  void begin(uint8_t cols, uint8_t rows);
+
+  void backlight();
+  void noBacklight();
+
+  void clear();
+  void home();
+  void setCursor(uint8_t col, uint8_t row);
+  size_t write(uint8_t c);
+  using Print::write;
+
+  // End the open Wire transmission (call at the end of each output slice)
+  void sync();
+
+  // Bus time the open transmission will take on sync(): 9 clocks per byte incl. ACK
+  uint16_t pendingMicros() const {
+    return (uint16_t)((uint32_t)(1 + pending_) * 9000000UL / LCD_I2C_CLOCK);
+  }
+
+  // Bus statistics: address + payload bytes and transactions since init()
+  uint32_t getBusBytes() const { return busBytes_; }
+  uint32_t getTransactions() const { return transactions_; }
+
+private:
+  uint8_t addr_;
+  uint8_t cols_;
+  uint8_t rows_;
+  uint8_t backlight_;  // Backlight bit OR-ed into every expander byte
+  uint8_t lastRs_;     // RS level of the last expander byte (0xFF = unknown)
+  uint8_t pending_;    // Bytes in the open transmission
+  uint32_t busBytes_;
+  uint32_t transactions_;
+
+  void command(uint8_t value);
+  void send(uint8_t value, uint8_t rs);
+  void writeNibbleInit(uint8_t nibble);
+  void reserve(uint8_t n);
+  void put(uint8_t b);
+};
+
+#endif // LCD_I2C_BATCHED
+
+#endif // LCDI2CBATCHED_H
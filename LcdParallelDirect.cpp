@@ -0,0 +1,106 @@
+#include "LcdParallelDirect.h"
+
+#if defined(LCD_PARALLEL_DIRECT_IO)
+
+// HD44780 commands
+static const uint8_t LCD_CLEARDISPLAY   = 0x01;
+static const uint8_t LCD_RETURNHOME     = 0x02;
+static const uint8_t LCD_ENTRYMODESET   = 0x04;
+static const uint8_t LCD_DISPLAYCONTROL = 0x08;
+static const uint8_t LCD_FUNCTIONSET    = 0x20;
+static const uint8_t LCD_SETDDRAMADDR   = 0x80;
+
+static const uint8_t LCD_ENTRYLEFT   = 0x02;  // Entry mode: increment, no shift
+static const uint8_t LCD_DISPLAYON   = 0x04;  // Display on, cursor off, blink off
+static const uint8_t LCD_2LINE       = 0x08;  // 4-bit bus, 2 lines, 5x8 font
+
+static const uint8_t LCD_EXEC_US  = 40;    // Data write / most commands: 37 us
+static const uint16_t LCD_CLEAR_US = 2000; // Clear / home: 1.52 ms
+
+LcdParallelDirect::LcdParallelDirect() : cols_(LCD_COLS), rows_(LCD_ROWS), lastByteUs_(0) {
+}
+
+void LcdParallelDirect::begin(uint8_t cols, uint8_t rows) {
+  cols_ = cols;
+  rows_ = rows;
+
+  fastpin::pinOutput<PIN_LCD_RS>();
+  fastpin::pinOutput<PIN_LCD_EN>();
+  fastpin::pinOutput<PIN_LCD_D4>();
+  fastpin::pinOutput<PIN_LCD_D5>();
+  fastpin::pinOutput<PIN_LCD_D6>();
+  fastpin::pinOutput<PIN_LCD_D7>();
+
+  // Power-on: wait >40 ms after Vcc rises, then force 4-bit mode (datasheet figure 24)
+  delayMicroseconds(50000);
+  fastpin::pinWrite<PIN_LCD_RS>(false);
+  fastpin::pinWrite<PIN_LCD_EN>(false);
+
+  write4bits(0x03);
+  delayMicroseconds(4500);
+  write4bits(0x03);
+  delayMicroseconds(4500);
+  write4bits(0x03);
+  delayMicroseconds(150);
+  write4bits(0x02);
+  delayMicroseconds(LCD_EXEC_US);
+
+  command(LCD_FUNCTIONSET | LCD_2LINE);
+  command(LCD_DISPLAYCONTROL | LCD_DISPLAYON);
+  clear();
+  command(LCD_ENTRYMODESET | LCD_ENTRYLEFT);
+}
+
+void LcdParallelDirect::clear() {
+  command(LCD_CLEARDISPLAY);
+  delayMicroseconds(LCD_CLEAR_US);
+}
+
+void LcdParallelDirect::home() {
+  command(LCD_RETURNHOME);
+  delayMicroseconds(LCD_CLEAR_US);
+}
+
+void LcdParallelDirect::setCursor(uint8_t col, uint8_t row) {
+  // Row offsets as in LiquidCrystal: 2004 rows 2/3 continue rows 0/1 in DDRAM
+  const uint8_t offsets[4] = { 0x00, 0x40, cols_, (uint8_t)(0x40 + cols_) };
+  if (row >= 4) row = 3;
+  if (row >= rows_) row = rows_ - 1;
+  command(LCD_SETDDRAMADDR | (uint8_t)(col + offsets[row]));
+}
+
+size_t LcdParallelDirect::write(uint8_t c) {
+  send(c, true);
+  return 1;
+}
+
+void LcdParallelDirect::command(uint8_t value) {
+  send(value, false);
+}
+
+void LcdParallelDirect::send(uint8_t value, bool data) {
+  // The controller is busy for ~37 us after each byte; wait only for what is left
+  while ((uint32_t)(micros() - lastByteUs_) < LCD_EXEC_US) {}
+
+  fastpin::pinWrite<PIN_LCD_RS>(data);
+  write4bits(value >> 4);
+  write4bits(value & 0x0F);
+  lastByteUs_ = micros();
+}
+
+void LcdParallelDirect::write4bits(uint8_t nibble) {
+  fastpin::pinWrite<PIN_LCD_D4>(nibble & 0x01);
+  fastpin::pinWrite<PIN_LCD_D5>(nibble & 0x02);
+  fastpin::pinWrite<PIN_LCD_D6>(nibble & 0x04);
+  fastpin::pinWrite<PIN_LCD_D7>(nibble & 0x08);
+
+  // Enable pulse: PWEH >= 450 ns (8 cycles at 16 MHz incl. the sbi), data latched on fall
+  fastpin::pinWrite<PIN_LCD_EN>(true);
+  __asm__ __volatile__("nop\n\tnop\n\tnop\n\tnop\n\tnop\n\tnop\n\t");
+  fastpin::pinWrite<PIN_LCD_EN>(false);
+  // Enable cycle time >= 1 us before the next nibble
+  __asm__ __volatile__("nop\n\tnop\n\tnop\n\tnop\n\tnop\n\tnop\n\tnop\n\tnop\n\t"
+                       "nop\n\tnop\n\tnop\n\tnop\n\tnop\n\tnop\n\t");
+}
+
+#endif // LCD_PARALLEL_DIRECT_IO
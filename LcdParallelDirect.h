@@ -0,0 +1,41 @@
+#ifndef LCDPARALLELDIRECT_H
+#define LCDPARALLELDIRECT_H
+
+#include <Arduino.h>
+#include "Config.h"
+#include "FastPin.h"
+
+#if defined(LCD_PARALLEL_DIRECT_IO)
+
+// ---------------- Direct port-register HD44780 driver (4-bit parallel) ----------------
+// Drop-in for the LiquidCrystal subset used by LCDDisplay. PIN_LCD_* are resolved to
+// PORTx address + bit mask at compile time (FastPin.h), so every pin change is a single
+// sbi/cbi instead of a digitalWrite() table walk. Instead of LiquidCrystal's fixed
+// 100 us wait after each nibble, the next byte only waits until the controller's 37 us
+// execution time has passed since the previous one (usually already over by then).
+class LcdParallelDirect : public Print {
+public:
+  LcdParallelDirect();
+
+  // Same as LiquidCrystal::begin(): power-on init into 4-bit, 2-line mode
+  void begin(uint8_t cols, uint8_t rows);
+
+  void clear();
+  void home();
+  void setCursor(uint8_t col, uint8_t row);
+  size_t write(uint8_t c);
+  using Print::write;
+
+private:
+  uint8_t cols_;
+  uint8_t rows_;
+  uint32_t lastByteUs_;  // micros() of the last byte, for the execution-time wait
+
+  void command(uint8_t value);
+  void send(uint8_t value, bool data);
+  void write4bits(uint8_t nibble);
+};
+
+#endif // LCD_PARALLEL_DIRECT_IO
+
+#endif // LCDPARALLELDIRECT_H
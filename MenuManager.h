@@ -5,6 +5,9 @@
 #include "LCDDisplay.h"
 #include "Settings.h"
 #include "Utils.h"
+#include "ButtonBank.h"
+#include "InputEvent.h"
+#include "CalTable.h"
 #include "Config.h"
 
 // ---------------- Menu Manager Class ----------------
@@ -20,6 +23,7 @@ public:
     SCR_CALMIN,
     SCR_CALMAX,
     SCR_INVERT,
+    SCR_CALTABLE,
   };
 
   // Callback function types for settings actions
@@ -33,21 +37,30 @@ public:
               CalMinCallback calMin, CalMaxCallback calMax, InvertToggleCallback invertToggle,
               Settings* settings);
 
-  // Process UI events and update display
-  // Button events: up, down, ok, back, okLong (okLong = long press on OK)
-  // btnUpHeld/btnDownHeld: true if button is currently held down (for rapid value change)
-  void update(uint16_t adc, uint16_t raw100, uint16_t shown100, 
-              bool btnUp, bool btnDown, bool btnOk, bool btnBack, bool btnOkLong = false,
-              bool btnUpHeld = false, bool btnDownHeld = false);
+  // Sensor values of one UI tick
+  struct SensorSnapshot {
+    uint16_t adc;       // Averaged ADC value (0..ADC_MAX)
+    uint16_t raw100;    // Calibrated angle, invert applied, no zero offset (0..35999)
+    uint16_t shown100;  // Displayed angle (raw100 - zero offset)
+    uint16_t display100;  // shown100 after the display filter (MAIN screen)
+    int16_t rate10;       // Angular rate from the display filter's tracker (0.1 °/s)
+  };
+
+  // Handle all queued input events, then render and flush the current screen
+  void update(SensorSnapshot snap, InputQueue& events);
+
+  // The two halves of update(), for callers that run them at different rates
+  void handleEvents(SensorSnapshot& snap, InputQueue& events);
+  void refresh(const SensorSnapshot& snap);
 
          // Get current screen
          Screen getCurrentScreen() const { return currentScreen_; }
          
          // Get current menu index (for debug)
          uint8_t getMenuIndex() const { return menuIdx_; }
-         
-         // Reset display smoothing (call after setting zero to show exact value immediately)
-         void resetDisplaySmoothing();
+
+  // UI ticks on which render() and flush() were skipped because nothing shown changed
+  uint32_t getSkippedFrames() const { return skippedFrames_; }
 
 private:
   LCDDisplay& lcd_;
@@ -58,26 +71,39 @@ private:
   uint16_t target100_; // 0..35999
   uint16_t step100_;   // 1=0.01°, 2=1min, 10=0.1°, 17=10min, 100=1°, 1000=10°, 10000=100°
   
+  // Calibration table editor state
+  enum CalStatus : uint8_t { CALST_NONE = 0, CALST_SAVED, CALST_ORDER, CALST_CLEARED };
+  uint8_t calPoint_;   // Reference point being captured (0..CAL_POINTS-1)
+  uint8_t calStatus_;  // CalStatus of the last action on this screen
+  
   // Menu items
-  static const uint8_t MENU_N = 2;
+  static const uint8_t MENU_N = 3;
   const char* menuItems_[MENU_N];
   
-  // Button event cooldown to prevent double-processing
-  uint32_t lastButtonEventMs_;
-  Screen previousScreen_;  // Track previous screen to detect transitions
-  static const uint32_t BUTTON_EVENT_COOLDOWN_MS = 200;  // Minimum time between button events (200ms)
-  
-  uint32_t lastOkLongPressMs_;  // Track when OK long press happened (for ignoring click after long press)
-  static const uint32_t OK_LONG_PRESS_IGNORE_CLICK_MS = 500;  // Ignore OK click for 500ms after long press
-  
-  // Display smoothing and hysteresis to prevent flickering of last digits
-  uint16_t lastDisplayedAngle100_;  // Last displayed angle value (for hysteresis)
-  uint16_t smoothedAngle100_;       // Smoothed angle value (exponential filter)
-  bool smoothingResetFlag_;         // Flag to indicate smoothing was reset (don't reinitialize from shown100)
-  static const uint16_t DISPLAY_HYSTERESIS_100 = 10;  // Minimum change to update display (0.10° = maximum stability)
-  static const uint8_t SMOOTHING_FACTOR = 2;  // Smoothing factor: lower = more smoothing (1-15, 2 = very strong smoothing)
-  static const uint16_t ZERO_THRESHOLD_100 = 20;  // If shown value is < 0.20° after reset, keep it at 0 (prevents 0.14° drift)
+  // Minimum time between handled clicks
+  uint32_t lastClickMs_;  // Time of the last handled click
+  static const uint32_t BUTTON_EVENT_COOLDOWN_MS = 200;
   
+  // Everything the current screen's text depends on; render() and flush() run only
+  // when it differs from the last rendered frame
+  struct RenderKey {
+    uint8_t screen;
+    uint8_t menuIdx;
+    uint8_t calPoint;
+    uint8_t calState;   // calStatus_, table active, point known
+    uint16_t target100;
+    uint16_t step100;
+    uint16_t zero100;
+    uint16_t calMin;
+    uint16_t calMax;
+    uint8_t flags;
+    uint8_t stored;     // settingsStored()
+    uint16_t value[2];  // Sensor values shown on this screen (0 when none)
+  };
+  RenderKey lastKey_;
+  bool lastKeyValid_;       // False until the first frame is rendered
+  uint32_t skippedFrames_;
+
   // Callbacks for settings actions
   SetZeroCallback setZero_;
   SetValueCallback setValue_;
@@ -93,15 +119,17 @@ private:
     return v;
   }
 
-  // Process button events and update state machine
-  // screenBefore is the screen state BEFORE processing (passed from update() to detect transitions)
-  // btnUpHeld/btnDownHeld: true if button is currently held down (for rapid value change)
-  void processEvents(uint16_t adc, uint16_t raw100, uint16_t shown100,
-                     bool btnUp, bool btnDown, bool btnOk, bool btnBack, bool btnOkLong, Screen screenBefore,
-                     bool btnUpHeld, bool btnDownHeld);
+  // Apply one input event to the state machine (may update snap after a quick zero)
+  void handleEvent(const InputEvent& ev, SensorSnapshot& snap);
+
+  // Set Value editor: move target100_ one step100_ up or down
+  void stepTarget(bool isUp);
+
+  // Collect the inputs of the current screen's text
+  RenderKey renderKey(const SensorSnapshot& snap) const;
 
-  // Render current screen to LCD
-  void render(uint16_t adc, uint16_t raw100, uint16_t shown100);
+  // Render current screen into the LCD line buffers (flushed by update())
+  void render(const SensorSnapshot& snap);
 };
 
 #endif // MENUMANAGER_H
@@ -14,7 +14,7 @@
          - P3022-V1-CW360 analog angle sensor
          
          Features:
-         - Reads P3022 analog output on A0 (ADC averaged for stability)
+         - Reads P3022 analog output on A0 (free-running ADC, averaged in the ADC interrupt)
          - Calibration MIN/MAX (stores to EEPROM with CRC validation)
          - Zero offset (Set Zero) stores to EEPROM
          - Set Value: set displayed angle to arbitrary target (e.g. 70.42°) by adjusting zero offset
@@ -48,6 +48,7 @@
     - RW=GND (read/write always low)
     - VCC=5V, GND=GND, V0=potentiometer (contrast)
     - Can customize pins by changing PIN_LCD_* below
+    - LCD_PARALLEL_DIRECT_IO in Config.h switches to the faster direct port-register driver
   
   P3022 Sensor:
     - OUT=A0 (analog input)
@@ -69,11 +70,20 @@
 #include "Config.h"
 
 // Include LCD library based on interface type (must be before LCDDisplay.h)
-#if defined(LCD_INTERFACE_I2C)
+#if defined(LCD_INTERFACE_I2C) && defined(LCD_I2C_BATCHED)
+#include <Wire.h>
+#include "LcdI2cBatched.h"
+  // Global LCD object (batched Wire transactions, see Config.h)
+  LcdI2cBatched lcd(LCD_I2C_ADDR, LCD_COLS, LCD_ROWS);
+#elif defined(LCD_INTERFACE_I2C)
 #include <Wire.h>
 #include <LiquidCrystal_I2C.h>
   // Global LCD object (will be used by LCDDisplay class)
   LiquidCrystal_I2C lcd(LCD_I2C_ADDR, LCD_COLS, LCD_ROWS);
+#elif defined(LCD_INTERFACE_PARALLEL_4BIT) && defined(LCD_PARALLEL_DIRECT_IO)
+  #include "LcdParallelDirect.h"
+  // Global LCD object (pins taken from PIN_LCD_* at compile time)
+  LcdParallelDirect lcd;
 #elif defined(LCD_INTERFACE_PARALLEL_4BIT)
   #include <LiquidCrystal.h>
   // Global LCD object (will be used by LCDDisplay class)
@@ -83,18 +93,31 @@
 // Include all module headers (order matters for dependencies)
 #include "Settings.h"
 #include "Sensor.h"
-#include "Button.h"
+#include "AngleFilter.h"
+#include "ButtonBank.h"
 #include "LCDDisplay.h"  // Requires lcd object defined above
 #include "Utils.h"
 #include "MenuManager.h"  // Requires LCDDisplay and Utils
+#include "Profiler.h"     // Per-stage loop timing (enabled by LOOP_PROFILER in Config.h)
+#include "Telemetry.h"    // Binary sensor stream on Serial (enabled by TELEMETRY in Config.h)
+#include "Scheduler.h"    // Periodic loop() tasks (task table below)
 #include <string.h>  // For memcpy in LCDDisplay
 
 // ---------------- Global Instances ----------------
-// Global button instances
-Button btnUp(PIN_BTN_UP);
-Button btnDown(PIN_BTN_DOWN);
-Button btnOk(PIN_BTN_OK);
-Button btnBack(PIN_BTN_BACK);
+// All buttons, sampled and debounced together
+ButtonBank buttons;
+
+// Button gestures waiting for the next UI tick
+InputQueue inputEvents;
+
+// MAIN screen angle filter, fed at the ADC block rate (parameters in Config.h);
+// the tracker stage also provides the angular rate
+typedef AlphaBetaStage<DISPLAY_AB_ALPHA_REST, DISPLAY_AB_ALPHA_MOVE, DISPLAY_AB_MOVE_100, ADC_BLOCK_US>
+        DisplayTracker;
+typedef AngleFilter<MedianStage<DISPLAY_MEDIAN_N>, DisplayTracker,
+                    DeadbandStage<DISPLAY_HYSTERESIS_100>, ZeroSnapStage<DISPLAY_ZERO_SNAP_100> >
+        DisplayFilter;
+DisplayFilter displayFilter;
 
 // Global LCD display instance (references global lcd object)
 LCDDisplay lcdDisplay(lcd);
@@ -103,12 +126,15 @@ LCDDisplay lcdDisplay(lcd);
 MenuManager* menuManager = nullptr;
 
 // Callback functions for menu actions (wrappers for settings functions)
+// Zero changes move the displayed angle in one step: restart the filter there
 void menuSetZero(uint16_t raw100) {
   doSetZero(raw100);
+  displayFilter.reset(0);
 }
 
 void menuSetValue(uint16_t raw100, uint16_t target100) {
   doSetValue(raw100, target100);
+  displayFilter.reset(target100);
 }
 
 void menuCalMin(uint16_t adc) {
@@ -123,10 +149,117 @@ void menuInvertToggle() {
   doInvertToggle();
 }
 
-       // ---------------- Timing Variables ----------------
-       // Timing constants are defined in Config.h
-       uint32_t lastButtonTick = 0;
-       uint32_t lastUiTick  = 0;
+// Current sensor values, as shown by the menu and sent as telemetry
+MenuManager::SensorSnapshot readSnapshot() {
+  PROF_START(PROF_ADC);
+  uint16_t adc    = readAdcAvg16();           // Latest averaged ADC value from background sampler (0..ADC_MAX)
+  PROF_STOP(PROF_ADC);
+  PROF_START(PROF_ANGLE);
+  uint16_t raw100 = adcToAngle100(adc);       // Convert to angle (0..35999, calibrated, invert applied, no zero offset)
+  uint16_t shown  = applyZero100(raw100);     // Apply zero offset to get displayed angle
+  PROF_STOP(PROF_ANGLE);
+
+  MenuManager::SensorSnapshot snap = { adc, raw100, shown, displayFilter.value(),
+                                      displayFilter.stage<DisplayTracker>().rate10() };
+  return snap;
+}
+
+#if defined(TELEMETRY)
+void sendTelemetry() {
+  uint32_t t = micros();
+  MenuManager::SensorSnapshot snap = readSnapshot();
+  TelemetryFrame f;
+  f.timeUs = t;
+  f.flags = (settingsStored() ? 0 : TELEMETRY_FLAG_UNSAVED) |
+            (displayFilter.stage<DisplayTracker>().isMoving() ? TELEMETRY_FLAG_MOVING : 0);
+  f.adc = snap.adc;
+  f.raw100 = snap.raw100;
+  f.shown100 = snap.shown100;
+  f.display100 = snap.display100;
+  f.rate10 = snap.rate10;
+  telemetrySend(f);
+}
+#endif
+
+// ---------------- Tasks ----------------
+// Button sampling and the menu's reaction to gestures, at the button rate: a click is
+// handled at once, not at the next display refresh
+void taskInput() {
+  PROF_START(PROF_INPUT);
+  buttons.update();
+  buttons.emitEvents(inputEvents);
+  PROF_STOP(PROF_INPUT);
+  if (menuManager && !inputEvents.empty()) {
+    MenuManager::SensorSnapshot snap = readSnapshot();
+    menuManager->handleEvents(snap, inputEvents);
+  }
+}
+
+// Display filter: one step per averaged ADC value
+void taskSensor() {
+  uint16_t sample;
+  if (sensorPoll(sample)) {
+    PROF_START(PROF_FILTER);
+    displayFilter.process(adcToShown100(sample));
+    PROF_STOP(PROF_FILTER);
+  }
+}
+
+// Write changed settings to EEPROM once they have settled
+void taskSettings() {
+  settingsPoll();
+
+  #if defined(POWER_FAIL_PIN)
+    // Supply about to drop: write pending settings now, not after the commit delay
+    if (digitalRead(POWER_FAIL_PIN) == LOW) settingsFlush();
+  #endif
+}
+
+// Render the current screen into the LCD queue (sent by taskLcdPump)
+void taskDisplay() {
+  PROF_START(PROF_UI_TICK);
+  if (menuManager) menuManager->refresh(readSnapshot());
+  PROF_STOP(PROF_UI_TICK);
+}
+
+// Background: send queued LCD updates in small time slices, so a full screen redraw
+// never holds up a due task for more than LCD_PUMP_BUDGET_US
+void taskLcdPump() {
+  if (!lcdDisplay.isIdle()) {
+    PROF_START(PROF_LCD_PUMP);
+    lcdDisplay.pump(LCD_PUMP_BUDGET_US);
+    PROF_STOP(PROF_LCD_PUMP);
+  }
+}
+
+static const char TASK_INPUT[] PROGMEM = "input";
+static const char TASK_SENSOR[] PROGMEM = "sensor";
+static const char TASK_SETTINGS[] PROGMEM = "settings";
+static const char TASK_DISPLAY[] PROGMEM = "display";
+static const char TASK_LCD[] PROGMEM = "lcd_pump";
+#if defined(TELEMETRY)
+static const char TASK_TELEMETRY[] PROGMEM = "telemetry";
+#endif
+#if defined(LOOP_PROFILER)
+static const char TASK_PROFILER[] PROGMEM = "profiler";
+#endif
+
+// Deadlines in ms after the release; equal deadlines run in priority order (0 first)
+static const SchedTask TASKS[] = {
+  // run           period               deadline  prio  name
+  { taskInput,     BUTTON_TICK_MS,      2,        0,    TASK_INPUT },
+  { taskSensor,    SENSOR_TICK_MS,      2,        1,    TASK_SENSOR },
+  #if defined(TELEMETRY)
+  { sendTelemetry, TELEMETRY_PERIOD_MS, 2,        2,    TASK_TELEMETRY },
+  #endif
+  { taskSettings,  SETTINGS_TICK_MS,    5,        3,    TASK_SETTINGS },
+  { taskDisplay,   UI_TICK_MS,          10,       4,    TASK_DISPLAY },
+  { taskLcdPump,   0,                   0,        5,    TASK_LCD },
+  #if defined(LOOP_PROFILER)
+  { profilerPoll,  0,                   0,        6,    TASK_PROFILER },
+  #endif
+};
+static_assert(sizeof(TASKS) / sizeof(TASKS[0]) <= SCHED_MAX_TASKS, "Raise SCHED_MAX_TASKS");
 
 void setup() {
   // Configure ADC reference
@@ -134,14 +267,18 @@ void setup() {
   // For 3.3V boards, use INTERNAL or EXTERNAL
   analogReference(DEFAULT);
 
+  // Start background ADC sampling (free-running, averaged in the ADC ISR)
+  sensorBegin();
+
   // Load settings from EEPROM (or defaults if first run)
   loadSettings();
 
-  // Initialize buttons (configure pins and read initial state)
-  btnUp.begin();
-  btnDown.begin();
-  btnOk.begin();
-  btnBack.begin();
+  #if defined(POWER_FAIL_PIN)
+    pinMode(POWER_FAIL_PIN, INPUT);
+  #endif
+
+  // Initialize buttons (configure pins)
+  buttons.begin();
 
   // Initialize LCD display and show startup message
   lcdDisplay.showStartup();
@@ -150,162 +287,21 @@ void setup() {
   static MenuManager menu(lcdDisplay, menuSetZero, menuSetValue, 
                           menuCalMin, menuCalMax, menuInvertToggle, &S);
   menuManager = &menu;
+
+  #if defined(LOOP_PROFILER)
+    profilerBegin();
+  #endif
+  #if defined(TELEMETRY)
+    telemetryBegin();
+  #endif
+
+  schedulerBegin(TASKS, sizeof(TASKS) / sizeof(TASKS[0]));
 }
 
 void loop() {
-  uint32_t now = millis();
-
-  // Button processing (debouncing and long press detection)
-  if ((uint32_t)(now - lastButtonTick) >= BUTTON_TICK_MS) {
-    lastButtonTick = now;
-    btnUp.update();
-    btnDown.update();
-    btnOk.update();
-    btnBack.update();
-  }
+  schedulerRun();
 
-  // UI tick (10ms = 100Hz update rate for smooth display)
-  if ((uint32_t)(now - lastUiTick) >= UI_TICK_MS) {
-    lastUiTick = now;
-
-    uint16_t adc    = readAdcAvg16();           // Read averaged ADC value (0..1023)
-    uint16_t raw100 = adcToAngle100(adc);       // Convert to angle (0..35999, calibrated, invert applied, no zero offset)
-    uint16_t shown  = applyZero100(raw100);     // Apply zero offset to get displayed angle
-
-    // Update menu with button events and sensor data
-    if (menuManager) {
-      // IMPORTANT: Check long press BEFORE wasPressed() because wasLongPressed() can only be called once per event
-      bool btnOkLong = btnOk.wasLongPressed();  // Long press OK for step size change in Set Value
-      bool btnBackLong = btnBack.wasLongPressed();  // Long press for quick set zero on main screen
-      
-      // Alternative method for OK long press detection (for step size change in Set Value)
-      // Change step size on RELEASE after long press, not during hold (more intuitive for user)
-      static uint32_t btnOkPressStart = 0;
-      static bool btnOkWasLongHeld = false;  // Flag: button was held >600ms during this press cycle
-      static bool btnOkPendingStepChange = false;  // Flag: step change should happen on release
-      static bool btnOkPreviousPinState = false;  // Track previous pin state to detect release transition
-      static bool btnOkStepChangeFired = false;  // Flag: step change was already fired for this press cycle (prevent double-trigger)
-      
-      bool btnOkPinPressed = !digitalRead(PIN_BTN_OK);
-      bool btnOkJustReleased = (btnOkPreviousPinState && !btnOkPinPressed);  // Detect release transition (true only once per release)
-      
-      if (btnOkPinPressed && btnOkPressStart == 0) {
-        // Button just pressed - start timer and reset all flags
-        btnOkPressStart = now;
-        btnOkWasLongHeld = false;
-        btnOkPendingStepChange = false;
-        btnOkStepChangeFired = false;  // Reset flag for new press cycle
-      } else if (btnOkPinPressed && btnOkPressStart > 0) {
-        // Button still pressed - check if held long enough (>600ms)
-        if (!btnOkWasLongHeld && (uint32_t)(now - btnOkPressStart) >= 600) {
-          btnOkWasLongHeld = true;
-          // Mark that step change should happen on RELEASE (only if in Set Value screen)
-          if (menuManager && menuManager->getCurrentScreen() == MenuManager::SCR_SETVALUE) {
-            btnOkPendingStepChange = true;
-          }
-        }
-      } else if (!btnOkPinPressed && btnOkPressStart > 0) {
-        // Button released - reset timer for next press cycle
-        btnOkPressStart = 0;
-      }
-      
-      // Update previous pin state for next cycle (for release detection)
-      btnOkPreviousPinState = btnOkPinPressed;
-      
-      // For Set Value screen: use ONLY manual detection (on release) to prevent double-trigger
-      // Button class wasLongPressed() fires during hold, manual timer fires on release
-      // Using both causes double step change (skipping one step size)
-      // Solution: ignore Button class wasLongPressed() for Set Value screen, use only manual timer
-      // IMPORTANT: btnOkStepChangeFired prevents double-trigger - step change fires only once per release
-      bool btnOkLongOnRelease = (btnOkJustReleased && btnOkPendingStepChange && btnOkWasLongHeld && 
-                                 !btnOkStepChangeFired &&
-                                 menuManager && menuManager->getCurrentScreen() == MenuManager::SCR_SETVALUE);
-      
-      // Mark that step change was fired (prevents double-trigger in same or next cycle)
-      if (btnOkLongOnRelease) {
-        btnOkStepChangeFired = true;
-        // Clear flags after firing to prevent re-triggering
-        btnOkPendingStepChange = false;
-        btnOkWasLongHeld = false;
-      }
-      
-      // Combine methods: for Set Value screen use only manual timer, for other screens use Button class
-      bool btnOkLongCombined;
-      if (menuManager && menuManager->getCurrentScreen() == MenuManager::SCR_SETVALUE) {
-        // Set Value: use ONLY manual timer (on release) to prevent double-trigger and give user control
-        btnOkLongCombined = btnOkLongOnRelease;
-      } else {
-        // Other screens: use Button class wasLongPressed() (normal behavior)
-        btnOkLongCombined = btnOkLong;
-      }
-      
-      // Quick set zero from main screen (long press BACK) - handle IMMEDIATELY
-      // Track button hold time manually using direct pin read (more reliable than Button class)
-      static uint32_t btnBackPressStart = 0;
-      static bool btnBackLongProcessed = false;  // Prevent multiple zero operations per press
-      
-      // Read pin directly to detect physical press state (LOW = pressed with pullup)
-      // This bypasses Button class state machine which might not work correctly
-      bool btnBackPinPressed = !digitalRead(PIN_BTN_BACK);
-      
-      if (btnBackPinPressed && btnBackPressStart == 0) {
-        // Button just pressed - start timer
-        btnBackPressStart = now;
-        btnBackLongProcessed = false;
-      } else if (!btnBackPinPressed) {
-        // Button released - reset timer and flag
-        btnBackPressStart = 0;
-        btnBackLongProcessed = false;
-      }
-      
-      // Check if button has been held for long time (>600ms)
-      bool btnBackLongHeld = (btnBackPressStart > 0 && (uint32_t)(now - btnBackPressStart) >= 600);
-      
-      // Check if we're on main screen and long press was detected (either wasLongPressed() or manual timer)
-      if (menuManager->getCurrentScreen() == MenuManager::SCR_MAIN && 
-          (btnBackLong || (btnBackLongHeld && !btnBackLongProcessed))) {
-        // To make current displayed value (shown) become exactly 0.00°:
-        // shown = raw100 - zero100, so zero100 = raw100 - shown
-        // If we want shown = 0, we need: zero100 = raw100 - 0 = raw100
-        // So we set zero100 to current raw100 value
-        menuSetZero(raw100);  // Set zero offset to current raw angle (makes displayed angle = 0.00°)
-        
-        // Recalculate shown value after setting zero (should be exactly 0)
-        shown = applyZero100(raw100);  // Recalculate: shown = raw100 - zero100 = raw100 - raw100 = 0
-        
-        // Reset display smoothing IMMEDIATELY to show exact 0.00° and prevent drift
-        // This must be done BEFORE update() call to prevent smoothing from "recovering" old value
-        menuManager->resetDisplaySmoothing();
-        
-        // Mark as processed to prevent multiple zero operations during same press
-        if (btnBackLongHeld) {
-          btnBackLongProcessed = true;
-        }
-      }
-      
-      // Get button events (automatically reset after reading)
-      bool btnUpEvent = btnUp.wasPressed();
-      bool btnDownEvent = btnDown.wasPressed();
-      bool btnOkEvent = btnOk.wasPressed();
-      bool btnBackEvent = btnBack.wasPressed();
-      
-      // If BACK long press was used for zeroing, don't trigger back action
-      if ((btnBackLong || btnBackLongHeld) && menuManager->getCurrentScreen() == MenuManager::SCR_MAIN) {
-        btnBackEvent = false;  // Prevent back action when using long press for zeroing
-      }
-      
-      // If OK long press is detected (for step size change in Set Value), don't trigger OK action
-      // This prevents accidental apply when user releases button after long press for step change
-      if (btnOkLongCombined && menuManager->getCurrentScreen() == MenuManager::SCR_SETVALUE) {
-        btnOkEvent = false;  // Prevent OK action when using long press for step size change
-      }
-      
-      // Check if Up/Down buttons are held down (for rapid value change in Set Value)
-      bool btnUpHeld = btnUp.isPressed();
-      bool btnDownHeld = btnDown.isPressed();
-      
-      // Update menu with button events
-      menuManager->update(adc, raw100, shown, btnUpEvent, btnDownEvent, btnOkEvent, btnBackEvent, btnOkLongCombined, btnUpHeld, btnDownHeld);
-    }
-  }
+  // Nothing left to send to the LCD: sleep until the next interrupt (scheduler tick,
+  // ADC block or button edge), quieter for the running conversion
+  if (lcdDisplay.isIdle()) sensorIdle();
 }
@@ -0,0 +1,166 @@
+#include "Profiler.h"
+#include "LCDDisplay.h"
+#include "ButtonBank.h"
+#include "MenuManager.h"
+#include "Scheduler.h"
+
+#if defined(LOOP_PROFILER)
+
+struct StageStats {
+  uint32_t count;
+  uint32_t sum;        // Total µs (wraps after ~71 min of pure stage time - reset with 'r')
+  uint16_t min;
+  uint16_t max;
+  uint16_t hist[PROF_HIST_BUCKETS];
+};
+
+static StageStats stats_[PROF_STAGES];
+
+extern MenuManager* menuManager;  // P3022-CW360-Batton_V1.2.ino
+
+void profilerBegin() {
+  Serial.begin(PROFILER_BAUD);
+  profilerReset();
+}
+
+void profilerReset() {
+  memset(stats_, 0, sizeof(stats_));
+  for (uint8_t i = 0; i < PROF_STAGES; i++) stats_[i].min = 0xFFFF;
+  schedulerResetStats();
+}
+
+void profilerRecord(uint8_t stage, uint32_t us) {
+  if (stage >= PROF_STAGES) return;
+  StageStats& st = stats_[stage];
+  uint16_t v = (us > 0xFFFF) ? 0xFFFF : (uint16_t)us;
+
+  st.count++;
+  st.sum += us;
+  if (v < st.min) st.min = v;
+  if (v > st.max) st.max = v;
+
+  // floor(log2(us)), 0 and 1 both land in bucket 0
+  uint8_t b = 0;
+  while (v > 1 && b < PROF_HIST_BUCKETS - 1) {
+    v >>= 1;
+    b++;
+  }
+  if (st.hist[b] != 0xFFFF) st.hist[b]++;  // Saturate instead of wrapping
+}
+
+void profilerPoll() {
+  while (Serial.available() > 0) {
+    int c = Serial.read();
+    if (c == 'p' || c == 'P') profilerReport(Serial);
+    else if (c == 'r' || c == 'R') {
+      profilerReset();
+      Serial.println(F("profiler: reset"));
+    }
+  }
+}
+
+// Right-align an unsigned value in a field of the given width
+static void printPadded(Print& out, uint32_t v, uint8_t width) {
+  uint8_t digits = 1;
+  for (uint32_t t = v; t >= 10; t /= 10) digits++;
+  while (digits++ < width) out.print(' ');
+  out.print(v);
+}
+
+static const __FlashStringHelper* stageName(uint8_t stage) {
+  switch (stage) {
+    case PROF_INPUT:        return F("input   ");
+    case PROF_ADC:          return F("adc     ");
+    case PROF_ANGLE:        return F("angle   ");
+    case PROF_FILTER:       return F("filter  ");
+    case PROF_MENU_EVENTS:  return F("menu_evt");
+    case PROF_RENDER:       return F("render  ");
+    case PROF_FLUSH:        return F("flush   ");
+    case PROF_LCD_PUMP:     return F("lcd_pump");
+    case PROF_LCD_BYTE:     return F("lcd_byte");
+    case PROF_UI_TICK:      return F("display ");
+    default:                return F("?       ");
+  }
+}
+
+void profilerReport(Print& out) {
+  out.print(F("--- loop profile, "));
+  out.print(F(BOARD_TYPE));
+  out.print(F(", UI tick "));
+  out.print(UI_TICK_MS);
+  out.print(F(" ms, LCD: "));
+  out.print(F(LCD_BACKEND_NAME));
+  out.println(F(" ---"));
+  out.println(F("stage        count   min  mean   max (us) | log2 histogram 1,2,4,..us"));
+
+  for (uint8_t i = 0; i < PROF_STAGES; i++) {
+    const StageStats& st = stats_[i];
+    out.print(stageName(i));
+    printPadded(out, st.count, 9);
+    printPadded(out, st.count ? st.min : 0, 6);
+    printPadded(out, st.count ? st.sum / st.count : 0, 6);
+    printPadded(out, st.max, 6);
+    out.print(F("      |"));
+
+    // Print only the populated bucket range to keep lines short
+    int8_t lo = -1, hi = -1;
+    for (uint8_t b = 0; b < PROF_HIST_BUCKETS; b++) {
+      if (st.hist[b]) {
+        if (lo < 0) lo = b;
+        hi = b;
+      }
+    }
+    if (lo >= 0) {
+      out.print(F(" ["));
+      out.print(1UL << lo);
+      out.print(F("us]"));
+      for (int8_t b = lo; b <= hi; b++) {
+        out.print(' ');
+        out.print(st.hist[b]);
+      }
+    }
+    out.println();
+  }
+
+  #if defined(LCD_I2C_BATCHED)
+    out.print(F("i2c: "));
+    out.print(lcd.getBusBytes());
+    out.print(F(" bytes on bus in "));
+    out.print(lcd.getTransactions());
+    out.println(F(" transactions"));
+  #endif
+
+  #if defined(BUTTON_PCINT)
+    out.print(F("button edge overflows: "));
+    out.println(ButtonBank::getEdgeOverflows());
+  #endif
+
+  // Scheduler: start latency after each release (jitter), releases skipped because the
+  // task was a whole period late, runs that finished after their deadline
+  out.println(F("task       period_ms deadline_ms      runs lat_mean_us lat_max_us  skipped overruns"));
+  for (uint8_t i = 0; i < schedulerTaskCount(); i++) {
+    const SchedTask& t = schedulerTask(i);
+    const SchedStats& st = schedulerStats(i);
+    out.print((const __FlashStringHelper*)t.name);
+    for (uint8_t n = strlen_P(t.name); n < 10; n++) out.print(' ');
+    if (t.periodMs == 0) {
+      out.println(F(" background"));
+      continue;
+    }
+    printPadded(out, t.periodMs, 10);
+    printPadded(out, t.deadlineMs, 12);
+    printPadded(out, st.runs, 10);
+    printPadded(out, st.runs ? st.latencySumUs / st.runs : 0, 12);
+    printPadded(out, st.latencyMaxUs, 11);
+    printPadded(out, st.skipped, 9);
+    printPadded(out, st.overruns, 9);
+    out.println();
+  }
+
+  if (menuManager) {
+    out.print(F("frames skipped: "));
+    out.println(menuManager->getSkippedFrames());
+  }
+}
+
+#endif // LOOP_PROFILER
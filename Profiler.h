@@ -0,0 +1,56 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <Arduino.h>
+#include "Config.h"
+
+// ---------------- Loop Profiler ----------------
+// Compile-time switch: LOOP_PROFILER in Config.h. When disabled all PROF_* macros
+// expand to nothing, so the firmware is byte-identical to an uninstrumented build.
+//
+// Usage:
+//   PROF_START(PROF_ADC);
+//   uint16_t adc = readAdcAvg16();
+//   PROF_STOP(PROF_ADC);
+
+enum ProfStage : uint8_t {
+  PROF_INPUT = 0,    // ButtonBank::update() + emitEvents() (input task)
+  PROF_ADC,          // readAdcAvg16()
+  PROF_ANGLE,        // adcToAngle100() + applyZero100()
+  PROF_FILTER,       // Display filter step (once per averaged ADC value)
+  PROF_MENU_EVENTS,  // MenuManager::handleEvents() (input task, only with queued gestures)
+  PROF_RENDER,       // MenuManager::render() (line formatting)
+  PROF_FLUSH,        // LCDDisplay::flush() (queueing changed spans)
+  PROF_LCD_PUMP,     // LCDDisplay::pump() (bytes to the controller)
+  PROF_LCD_BYTE,     // Time per LCD byte inside pump() (compares LCD backends)
+  PROF_UI_TICK,      // Display task: MenuManager::refresh() (snapshot + render + flush, UI_TICK_MS)
+  PROF_STAGES
+};
+
+#if defined(LOOP_PROFILER)
+
+static const uint8_t PROF_HIST_BUCKETS = 16;  // Bucket i: 2^i <= us < 2^(i+1) (bucket 0 includes 0)
+
+// Start serial port and clear statistics (call from setup())
+void profilerBegin();
+
+// Record one measurement for a stage
+void profilerRecord(uint8_t stage, uint32_t us);
+
+// Handle serial commands ('p' = report, 'r' = reset); background task
+void profilerPoll();
+
+void profilerReport(Print& out);
+void profilerReset();
+
+#define PROF_START(stage) uint32_t prof_t0_##stage = micros()
+#define PROF_STOP(stage) profilerRecord(stage, micros() - prof_t0_##stage)
+
+#else
+
+#define PROF_START(stage)
+#define PROF_STOP(stage)
+
+#endif // LOOP_PROFILER
+
+#endif // PROFILER_H
@@ -0,0 +1,134 @@
+#include "Scheduler.h"
+
+struct TaskState {
+  uint32_t releaseUs;  // Current (or next) release
+  SchedStats stats;
+};
+
+static const SchedTask* tasks_ = nullptr;
+static uint8_t count_ = 0;
+static TaskState state_[SCHED_MAX_TASKS];
+
+#if defined(__AVR__)
+// Timer1 in CTC mode at clk/64: one compare match per tick
+static const uint8_t TIMER_PRESCALE = 64;
+static const uint8_t COUNT_US = TIMER_PRESCALE / (F_CPU / 1000000UL);  // 4 us at 16 MHz
+static const uint32_t TICK_COUNTS = (uint32_t)SCHED_TICK_US / COUNT_US;
+static_assert(TIMER_PRESCALE % (F_CPU / 1000000UL) == 0, "Scheduler: F_CPU must divide 64 MHz");
+static_assert(SCHED_TICK_US % COUNT_US == 0 && TICK_COUNTS <= 65536UL,
+              "Scheduler: SCHED_TICK_US must be a multiple of the timer step (max 65536 steps)");
+
+static volatile uint32_t ticks_ = 0;
+
+ISR(TIMER1_COMPA_vect) {
+  ticks_++;
+}
+
+static void tickBegin() {
+  noInterrupts();
+  TCCR1A = 0;
+  TCCR1B = (1 << WGM12) | (1 << CS11) | (1 << CS10);  // CTC on OCR1A, clk/64
+  TCNT1 = 0;
+  OCR1A = (uint16_t)(TICK_COUNTS - 1);
+  TIFR1 = (1 << OCF1A);
+  TIMSK1 |= (1 << OCIE1A);
+  interrupts();
+}
+
+// Ticks and the timer count read together; a compare match that is pending because
+// interrupts are off has already restarted the count, so it is added here
+static uint32_t nowUs() {
+  noInterrupts();
+  uint32_t t = ticks_;
+  uint16_t c = TCNT1;
+  if ((TIFR1 & (1 << OCF1A)) && c < TICK_COUNTS / 2) t++;
+  interrupts();
+  return t * SCHED_TICK_US + (uint32_t)c * COUNT_US;
+}
+#else
+static void tickBegin() {
+}
+
+static uint32_t nowUs() {
+  return micros();
+}
+#endif
+
+void schedulerBegin(const SchedTask* tasks, uint8_t count) {
+  tasks_ = tasks;
+  count_ = (count < SCHED_MAX_TASKS) ? count : SCHED_MAX_TASKS;
+  tickBegin();
+  uint32_t now = nowUs();
+  for (uint8_t i = 0; i < count_; i++) state_[i].releaseUs = now;
+  schedulerResetStats();
+}
+
+// Released task with the earliest deadline, or -1 (drops releases a whole period late)
+static int8_t mostUrgent(uint32_t now) {
+  int8_t best = -1;
+  int32_t bestSlack = 0;
+  for (uint8_t i = 0; i < count_; i++) {
+    const SchedTask& t = tasks_[i];
+    TaskState& s = state_[i];
+    if (t.periodMs == 0) continue;
+    int32_t late = (int32_t)(now - s.releaseUs);
+    if (late < 0) continue;  // Not released yet
+
+    uint32_t periodUs = t.periodMs * 1000UL;
+    if ((uint32_t)late >= periodUs) {
+      uint32_t missed = (uint32_t)late / periodUs;
+      s.releaseUs += missed * periodUs;
+      late -= (int32_t)(missed * periodUs);
+      uint32_t skipped = s.stats.skipped + missed;
+      s.stats.skipped = (skipped > 0xFFFF) ? 0xFFFF : (uint16_t)skipped;
+    }
+
+    // Earliest absolute deadline = least time left until it
+    int32_t slack = (int32_t)(t.deadlineMs * 1000UL) - late;
+    if (best < 0 || slack < bestSlack ||
+        (slack == bestSlack && t.priority < tasks_[best].priority)) {
+      best = (int8_t)i;
+      bestSlack = slack;
+    }
+  }
+  return best;
+}
+
+void schedulerRun() {
+  int8_t i;
+  while ((i = mostUrgent(nowUs())) >= 0) {
+    const SchedTask& t = tasks_[i];
+    TaskState& s = state_[i];
+    uint32_t start = nowUs();
+    t.run();
+    uint32_t end = nowUs();
+
+    uint32_t latency = start - s.releaseUs;
+    SchedStats& st = s.stats;
+    st.runs++;
+    st.latencySumUs += latency;
+    if (latency > st.latencyMaxUs) st.latencyMaxUs = (latency > 0xFFFF) ? 0xFFFF : (uint16_t)latency;
+    if (end - s.releaseUs > t.deadlineMs * 1000UL && st.overruns != 0xFFFF) st.overruns++;
+    s.releaseUs += t.periodMs * 1000UL;
+  }
+
+  for (uint8_t j = 0; j < count_; j++) {
+    if (tasks_[j].periodMs == 0) tasks_[j].run();
+  }
+}
+
+uint8_t schedulerTaskCount() {
+  return count_;
+}
+
+const SchedTask& schedulerTask(uint8_t i) {
+  return tasks_[i];
+}
+
+const SchedStats& schedulerStats(uint8_t i) {
+  return state_[i].stats;
+}
+
+void schedulerResetStats() {
+  for (uint8_t i = 0; i < count_; i++) memset(&state_[i].stats, 0, sizeof(SchedStats));
+}
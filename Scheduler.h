@@ -0,0 +1,51 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <Arduino.h>
+#include "Config.h"
+
+// ---------------- Cooperative deadline scheduler ----------------
+// loop() work as a static table of periodic tasks, each with its own period, deadline
+// and priority. Timer1 interrupts every SCHED_TICK_US and is the scheduler's clock
+// (ticks + timer count: microsecond resolution, no drift against the periods).
+// schedulerRun() runs the released tasks in order of their deadlines (equal deadlines:
+// lower priority number first), then the background tasks once. Tasks run to
+// completion, so each must be short; long jobs (LCD output) work in budgeted slices as
+// background tasks, and due tasks are checked again after every slice.
+//
+// Releases are fixed-rate (one period after the previous release, not after the run).
+// A task that falls a whole period or more behind skips the missed releases instead of
+// running in a burst.
+//
+// Boards without the AVR Timer1 registers use micros() as the clock.
+
+struct SchedTask {
+  void (*run)();
+  uint16_t periodMs;    // 0: background task, runs on every pass without a due task
+  uint16_t deadlineMs;  // Should finish this long after its release (<= periodMs)
+  uint8_t priority;     // Ties between equal deadlines: 0 = most urgent
+  const char* name;     // PROGMEM string, for reports
+};
+
+// Per task counters (reset with schedulerResetStats())
+struct SchedStats {
+  uint32_t runs;
+  uint32_t latencySumUs;  // Release -> start, for the mean (wraps after ~71 min of latency)
+  uint16_t latencyMaxUs;  // Jitter: worst start after the release
+  uint16_t skipped;       // Releases dropped because the task was a period behind
+  uint16_t overruns;      // Runs that finished after release + deadline
+};
+
+// Start the tick and release every task now (count <= SCHED_MAX_TASKS; the table
+// must stay valid). Call at the end of setup().
+void schedulerBegin(const SchedTask* tasks, uint8_t count);
+
+// Run every due task, most urgent first, then the background tasks (call from loop())
+void schedulerRun();
+
+uint8_t schedulerTaskCount();
+const SchedTask& schedulerTask(uint8_t i);
+const SchedStats& schedulerStats(uint8_t i);
+void schedulerResetStats();
+
+#endif // SCHEDULER_H
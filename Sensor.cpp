@@ -1,40 +1,205 @@
 #include "Sensor.h"
+#include "CalTable.h"
+
+#if defined(__AVR__)
+  #include <avr/sleep.h>
+#endif
+
+// Oversampling: keep ADC_EXTRA_BITS of the block sum below the 10-bit point
+static const uint8_t ADC_DECIMATE_SHIFT = ADC_AVG_SHIFT - ADC_EXTRA_BITS;
 
 extern Settings S;
 
+#if defined(__AVR__)
+// Written by the ADC ISR, read by loop() (multi-byte -> read with interrupts disabled)
+static volatile uint32_t adcBlockSum_ = 0;   // Sum of the last completed block
+static volatile bool adcBlockValid_ = false; // At least one block completed
+static volatile uint8_t adcBlockSeq_ = 0;    // Incremented per completed block
+
+// ISR-only accumulator state
+static uint32_t adcAcc_ = 0;
+static uint16_t adcCount_ = 0;
+
+// ADC conversion complete (free-running mode: next conversion already started)
+ISR(ADC_vect) {
+  adcAcc_ += ADC;
+  if (++adcCount_ >= (1U << ADC_AVG_SHIFT)) {
+    adcBlockSum_ = adcAcc_;
+    adcBlockValid_ = true;
+    adcBlockSeq_++;
+    adcAcc_ = 0;
+    adcCount_ = 0;
+  }
+}
+
+void sensorBegin() {
+  // Let the core select reference and channel for PIN_ANGLE (handles MUX5 on 32U4),
+  // then keep that ADMUX setting and switch the ADC to free-running mode
+  analogRead(PIN_ANGLE);
+
+  noInterrupts();
+  adcAcc_ = 0;
+  adcCount_ = 0;
+  adcBlockValid_ = false;
+  ADCSRB &= ~((1 << ADTS2) | (1 << ADTS1) | (1 << ADTS0));  // Auto trigger source: free running
+  ADCSRA = (1 << ADEN) | (1 << ADSC) | (1 << ADATE) | (1 << ADIE) | (ADC_PRESCALER_BITS & 0x07);
+  interrupts();
+
+  // Wait for the first block so readAdcAvg16() never returns a partial value (~7ms at /128)
+  while (!adcBlockValid_) {}
+}
+
+uint16_t readAdcAvg16() {
+  noInterrupts();
+  uint32_t sum = adcBlockSum_;
+  interrupts();
+  return (uint16_t)(sum >> ADC_DECIMATE_SHIFT); // 0..ADC_MAX
+}
+
+bool sensorPoll(uint16_t& adc) {
+  static uint8_t lastSeq = 0;
+  noInterrupts();
+  uint8_t seq = adcBlockSeq_;
+  uint32_t sum = adcBlockSum_;
+  interrupts();
+  if (seq == lastSeq) return false;
+  lastSeq = seq;
+  adc = (uint16_t)(sum >> ADC_DECIMATE_SHIFT);
+  return true;
+}
+
+void sensorIdle() {
+  #if defined(ADC_IDLE_SLEEP)
+    // Any interrupt wakes the CPU; the free-running ADC alone fires every ~104 us
+    set_sleep_mode(SLEEP_MODE_IDLE);
+    sleep_mode();
+  #endif
+}
+#else
+// Boards without AVR ADC registers: plain averaged analogRead() without settling delays
+void sensorBegin() {
+}
+
 uint16_t readAdcAvg16() {
   uint32_t acc = 0;
-  // Increased averaging from 16 to 64 samples for maximum stability and reduced noise
-  // This provides better noise reduction at the cost of slightly longer read time (~6.4ms)
-  for (uint8_t i = 0; i < 64; i++) {
+  for (uint16_t i = 0; i < (1U << ADC_AVG_SHIFT); i++) {
     acc += analogRead(PIN_ANGLE);
-    // Small delay between reads for better stability and ADC settling
-    // ADC conversion takes ~100us, delay ensures stable readings
-    if (i < 63) delayMicroseconds(100);
   }
-  return (uint16_t)(acc >> 6); // Divide by 64 => 0..1023
+  return (uint16_t)(acc >> ADC_DECIMATE_SHIFT); // 0..ADC_MAX
 }
 
-uint16_t adcToAngle100(uint16_t adc) {
-  int32_t a = adc;
+void sensorIdle() {
+}
+
+// Paced like the free-running AVR sampler (ADC_BLOCK_US per value): fixed rate however
+// often it is polled, resynchronised after a stall
+bool sensorPoll(uint16_t& adc) {
+  static uint32_t lastUs = 0;
+  uint32_t now = micros();
+  if ((uint32_t)(now - lastUs) < ADC_BLOCK_US) return false;
+  lastUs += ADC_BLOCK_US;
+  if ((uint32_t)(now - lastUs) >= ADC_BLOCK_US) lastUs = now;
+  adc = readAdcAvg16();
+  return true;
+}
+#endif
+
+// ---------------- Calibration transform ----------------
+// angle = (adc - calMin) * 36000 / span, with the division replaced by a 16.16
+// reciprocal computed once per settings change. mult is rounded up, so the result
+// matches the exact quotient or is at most 1 (0.01 deg) above it; x <= span keeps
+// x * mult below 36000 * 2^16 + span, i.e. in 32 bits.
+static CalTransform cal_ = { 0, ADC_FULL_SCALE, (36000UL << 16) / ADC_FULL_SCALE + 1, 36000, false };
+
+// Multi-point table (CalTable.h): piecewise-linear between the points, with the
+// segment found by indexing on the high ADC bits. segStart_[bin] is the segment that
+// contains the first code of the bin; the scan from there only steps past the (rare)
+// points inside the bin. Each segment is base + (adc - start) * mult >> 16 like cal_.
+static const uint8_t SEG_SHIFT = ADC_BITS - CAL_LUT_BITS;
+static const uint16_t SEG_BINS = 1U << CAL_LUT_BITS;
+static const uint8_t SEGMENTS = CAL_POINTS - 1;
+static uint8_t segStart_[SEG_BINS];
+static uint32_t segMult_[SEGMENTS];  // ceil(angle span * 2^16 / ADC span)
+static uint16_t segBase_[SEGMENTS];  // Angle at the segment start
+static bool tableActive_ = false;
 
-  // clamp by calibration
-  if (a < (int32_t)S.calMin) a = S.calMin;
-  if (a > (int32_t)S.calMax) a = S.calMax;
+static void buildTableLookup() {
+  for (uint8_t j = 0; j < SEGMENTS; j++) {
+    uint16_t dx = calTableAdc(j + 1) - calTableAdc(j);
+    uint32_t da = calTableAngle100(j + 1) - calTableAngle100(j);
+    segBase_[j] = calTableAngle100(j);
+    segMult_[j] = ((da << 16) + dx - 1) / dx;
+  }
+  uint8_t j = 0;
+  for (uint16_t k = 0; k < SEG_BINS; k++) {
+    uint32_t x = (uint32_t)k << SEG_SHIFT;
+    while (j + 1 < SEGMENTS && calTableAdc(j + 1) <= x) j++;
+    segStart_[k] = j;
+  }
+}
 
-  int32_t span = (int32_t)S.calMax - (int32_t)S.calMin;
-  if (span < 1) span = 1;
+static inline uint16_t tableScale(uint16_t adc) {
+  if (adc <= calTableAdc(0)) return 0;
+  if (adc >= calTableAdc(CAL_POINTS - 1)) return 0;  // 360° wraps to 0
+  uint8_t j = segStart_[adc >> SEG_SHIFT];
+  while (j + 1 < SEGMENTS && adc >= calTableAdc(j + 1)) j++;
+  uint16_t a = segBase_[j] + (uint16_t)(((uint32_t)(adc - calTableAdc(j)) * segMult_[j]) >> 16);
+  return (a >= 36000) ? 0 : a;
+}
 
-  // 0..35999 (0.01°). If calc reaches 36000, wrap to 0.
-  int32_t ang100 = ((a - (int32_t)S.calMin) * 36000L) / span;
-  if (ang100 >= 36000) ang100 = 0;
+void sensorCalRebuild() {
+  CalTransform t;
+  t.calMin = S.calMin;
+  t.calMax = (S.calMax > S.calMin) ? S.calMax : S.calMin + 1;
+  uint16_t span = t.calMax - t.calMin;
+  t.mult = ((36000UL << 16) + span - 1) / span;
+  t.base = 36000 - S.zero100;
+  t.invert = (S.flags & 0x01) != 0;
 
-  // optional invert
-  if (S.flags & 0x01) {
-    ang100 = 36000 - ang100;
-    if (ang100 >= 36000) ang100 = 0;
+  // Conversions run in loop() only (no ISR reads the transform), so both the transform
+  // and the lookup are replaced in place
+  cal_ = t;
+  tableActive_ = false;
+  if (calTableActive()) {
+    buildTableLookup();
+    tableActive_ = true;
   }
-  return (uint16_t)ang100;
+}
+
+bool sensorCalTransform(CalTransform& t) {
+  t = cal_;
+  return tableActive_;
+}
+
+// Calibrated angle 0..35999 before inversion
+static inline uint16_t calScale(uint16_t adc) {
+  if (tableActive_) return tableScale(adc);
+  if (adc < cal_.calMin) adc = cal_.calMin;
+  if (adc > cal_.calMax) adc = cal_.calMax;
+  uint16_t a = (uint16_t)(((uint32_t)(adc - cal_.calMin) * cal_.mult) >> 16);
+  return (a >= 36000) ? 0 : a;  // Full scale wraps to 0
+}
+
+uint16_t adcToAngle100(uint16_t adc) {
+  uint16_t a = calScale(adc);
+  if (cal_.invert && a != 0) a = 36000 - a;
+  return a;
+}
+
+uint16_t adcToShown100(uint16_t adc) {
+  uint16_t a = calScale(adc);
+  // (raw - zero) mod 36000 = (base +/- a) mod 36000, base = 36000 - zero in 1..36000
+  int32_t v = cal_.invert ? (int32_t)cal_.base - a : (int32_t)cal_.base + a;
+  if (v < 0) v += 36000;
+  else if (v >= 36000) v -= 36000;
+  return (uint16_t)v;
+}
+uint16_t adcRescale(uint16_t adc, uint8_t extraBits) {
+  if (extraBits > ADC_EXTRA_BITS) return adc >> (extraBits - ADC_EXTRA_BITS);
+  if (extraBits == ADC_EXTRA_BITS) return adc;
+  uint8_t d = ADC_EXTRA_BITS - extraBits;
+  uint32_t v = ((uint32_t)adc << d) + (1U << (d - 1));
+  return (v > ADC_FULL_SCALE) ? ADC_FULL_SCALE : (uint16_t)v;
 }
 
 uint16_t applyZero100(uint16_t angle100) {
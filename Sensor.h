@@ -6,15 +6,55 @@
 #include "Settings.h"
 
 // ---------------- ADC / angle math ----------------
-// Read ADC with averaging for better stability
-// Compatible with all AVR boards (Uno/Nano/Micro have same ADC resolution: 10-bit = 0-1023)
+// Start background sampling of PIN_ANGLE (free-running ADC + ADC-complete ISR)
+// Call once from setup() after analogReference(); blocks only until the first
+// averaged value is available. Do not call analogRead() afterwards - the ADC is busy.
+void sensorBegin();
+
+// Latest averaged ADC value (2^ADC_AVG_SHIFT samples), non-blocking O(1) read
+// 0..ADC_MAX: 10-bit plus ADC_EXTRA_BITS from oversampling (see Config.h)
 uint16_t readAdcAvg16();
 
+// True once per newly completed averaging block (~150/s, see Config.h), which is then
+// stored in adc; false if no block finished since the last call. Drives per-sample filters.
+bool sensorPoll(uint16_t& adc);
+
+// Idle-sleep until the next interrupt (ADC_IDLE_SLEEP in Config.h, no-op otherwise)
+void sensorIdle();
+
+// Rebuild the cached calibration transform from S (calMin/calMax, invert, zero) and
+// the calibration table (CalTable.h, used instead of calMin/calMax while active)
+// Called by loadSettings()/saveSettings(); call it after changing S any other way
+void sensorCalRebuild();
+
 // Convert ADC value to angle (centidegrees: 0..35999)
-// Applies calibration and optional inversion
+// Applies calibration and optional inversion (cached transform: clamp + multiply-shift,
+// or table lookup + interpolation)
 uint16_t adcToAngle100(uint16_t adc);
 
+// ADC value saved with extraBits (another ADC_EXTRA_BITS) on the current scale: the
+// centre of the codes it covers, (adc << d) + 2^(d-1), at most ADC_FULL_SCALE; one rule
+// for every stored calibration value, so a rescaled span keeps its gain
+uint16_t adcRescale(uint16_t adc, uint8_t extraBits);
+
 // Apply zero offset to angle
 uint16_t applyZero100(uint16_t angle100);
 
+// adcToAngle100() + applyZero100() in one step, zero offset folded into the transform
+uint16_t adcToShown100(uint16_t adc);
+
+// Cached two-point transform: angle = (clamp(adc, calMin, calMax) - calMin) * mult >> 16,
+// 36000 wraps to 0, then inversion (details in Sensor.cpp)
+struct CalTransform {
+  uint16_t calMin;
+  uint16_t calMax;
+  uint32_t mult;     // ceil(36000 * 2^16 / span)
+  uint16_t base;     // 36000 - zero100: zero offset folded into adcToShown100()
+  bool     invert;
+};
+
+// Copy of the transform in use (for host/common/AngleBatch.h); true while the
+// calibration table replaces the two-point line
+bool sensorCalTransform(CalTransform& t);
+
 #endif // SENSOR_H
@@ -1,36 +1,245 @@
 #include "Settings.h"
+#include "Sensor.h"
+#include "CalTable.h"
+#include "EepromWriter.h"
+#include "Crc16.h"
+#include <stddef.h>
 
 Settings S;
 
-uint8_t simple_crc(const Settings& s) {
+// ---------------- Settings records ----------------
+// Settings are stored as versioned records: a header (magic, schema version, payload
+// length, sequence number, CRC-16 over header and payload) followed by the Settings
+// payload. New fields are appended to Settings with SETTINGS_VERSION incremented and a
+// step in migrateRecord(); a record written by newer firmware is read up to the fields
+// this firmware knows, so neither an upgrade nor a downgrade resets the calibration.
+//
+// Each commit writes a record into the next slot of a ring (journal) that fills the
+// EEPROM after the calibration table, so a cell is written once per JOURNAL_SLOTS
+// commits instead of on every change. The newest record is the valid one with the
+// highest sequence number; a torn write fails its CRC and the previous record wins.
+//
+// Older layouts, read (and then written as a current record) only while the journal
+// holds no current record:
+//   0: one Settings copy with an XOR crc at address 0 (before the journal)
+//   1: 10-byte records {seq, Settings with XOR crc} from JOURNAL_START
+static const uint16_t SETTINGS_MAGIC = 0x3350;  // "P3" in EEPROM byte order
+static const uint8_t SETTINGS_VERSION = 2;
+
+struct RecordHeader {
+  uint16_t magic;    // SETTINGS_MAGIC
+  uint8_t  version;  // Schema version of the payload
+  uint8_t  length;   // Payload bytes following the header
+  uint16_t seq;      // Journal sequence number
+  uint16_t crc;      // CRC-16 of the header bytes before crc, then the payload
+};
+
+struct SettingsRecord {
+  RecordHeader h;
+  Settings s;
+};
+
+static const int LEGACY_SETTINGS_ADDR = 0;
+static const int JOURNAL_START = 160;      // Fixed: room for a 65-point calibration table
+static const uint8_t JOURNAL_SLOT = 24;    // Fixed: payloads up to 16 bytes fit
+static const uint8_t PAYLOAD_MAX = JOURNAL_SLOT - sizeof(RecordHeader);
+static const uint8_t JOURNAL_SLOTS = (E2END + 1 - JOURNAL_START) / JOURNAL_SLOT;
+static_assert(CAL_TABLE_EEPROM_ADDR + sizeof(CalTable) <= JOURNAL_START,
+              "Calibration table overlaps the settings journal");
+static_assert(sizeof(Settings) <= PAYLOAD_MAX, "Settings outgrew the journal slot");
+
+static uint8_t headSlot_ = JOURNAL_SLOTS - 1;  // Slot of the newest record (next commit: +1)
+static uint16_t headSeq_ = 0;
+static bool dirty_ = false;                    // S differs from the newest record
+static SettingsRecord pending_;                // Record being written (source of the writer job)
+static uint32_t changedMs_ = 0;                // millis() of the last saveSettings()
+
+static int recordAddr(uint8_t slot) {
+  return JOURNAL_START + (int)slot * JOURNAL_SLOT;
+}
+
+static uint16_t recordCrc(const RecordHeader& h, const void* payload) {
+  return crc16(payload, h.length, crc16(&h, offsetof(RecordHeader, crc)));
+}
+
+// Bring a payload of the given schema version to the current Settings layout
+// (false for a layout this firmware cannot read)
+static bool migrateRecord(uint8_t version, const uint8_t* payload, uint8_t length, Settings& out) {
+  memset(&out, 0, sizeof(out));
+  if (version < SETTINGS_VERSION) return false;  // Versions 0/1 never had a header
+  // Version 2 is the current layout; later versions only append fields
+  memcpy(&out, payload, (length < sizeof(out)) ? length : sizeof(out));
+  out.reserved = 0;
+  return true;
+}
+
+// Find the newest valid record (false if the journal holds none);
+// outdated is set when it was migrated from an older schema version
+static bool journalLoad(Settings& out, bool& outdated) {
+  bool found = false;
+  for (uint8_t slot = 0; slot < JOURNAL_SLOTS; slot++) {
+    uint8_t buf[JOURNAL_SLOT];
+    RecordHeader h;
+    EEPROM.get(recordAddr(slot), h);
+    if (h.magic != SETTINGS_MAGIC || h.length > PAYLOAD_MAX) continue;  // Cheap reject first
+    // All records in the ring are from the last JOURNAL_SLOTS commits: serial compare
+    if (found && (int16_t)(h.seq - headSeq_) <= 0) continue;
+    for (uint8_t i = 0; i < h.length; i++) buf[i] = EEPROM.read(recordAddr(slot) + sizeof(h) + i);
+    Settings s;
+    if (h.crc != recordCrc(h, buf) || !migrateRecord(h.version, buf, h.length, s)) continue;
+    found = true;
+    headSlot_ = slot;
+    headSeq_ = h.seq;
+    out = s;
+    outdated = (h.version < SETTINGS_VERSION);
+  }
+  return found;
+}
+
+// Layouts 0 and 1 (see above)
+struct SettingsV0 {
+  uint16_t zero100;
+  uint16_t calMin;
+  uint16_t calMax;
+  uint8_t  flags;
+  uint8_t  crc;      // XOR of the bytes before it
+};
+
+struct SettingsRecordV1 {
+  uint16_t seq;
+  SettingsV0 s;      // s.crc also covers seq
+};
+
+static uint8_t crcV0(const SettingsV0& s) {
   const uint8_t* p = (const uint8_t*)&s;
   uint8_t c = 0;
-  for (size_t i = 0; i < sizeof(Settings) - 1; i++) c ^= p[i];
+  for (size_t i = 0; i < offsetof(SettingsV0, crc); i++) c ^= p[i];
   return c;
 }
 
+static void migrateV0(const SettingsV0& v0, Settings& out) {
+  memset(&out, 0, sizeof(out));
+  out.zero100 = v0.zero100;
+  out.calMin = v0.calMin;
+  out.calMax = v0.calMax;
+  out.flags = v0.flags;
+}
+
+static bool loadV1(Settings& out) {
+  static const uint8_t SLOTS_V1 = (E2END + 1 - JOURNAL_START) / sizeof(SettingsRecordV1);
+  bool found = false;
+  for (uint8_t slot = 0; slot < SLOTS_V1; slot++) {
+    SettingsRecordV1 r;
+    EEPROM.get(JOURNAL_START + slot * (int)sizeof(SettingsRecordV1), r);
+    if (r.s.crc != (0xA5 ^ crcV0(r.s) ^ (uint8_t)r.seq ^ (uint8_t)(r.seq >> 8))) continue;
+    if (!found || (int16_t)(r.seq - headSeq_) > 0) {
+      found = true;
+      headSeq_ = r.seq;  // Current records continue the sequence
+      migrateV0(r.s, out);
+    }
+  }
+  return found;
+}
+
+static bool loadV0(Settings& out) {
+  SettingsV0 v0;
+  EEPROM.get(LEGACY_SETTINGS_ADDR, v0);
+  if (v0.crc != crcV0(v0)) return false;
+  migrateV0(v0, out);
+  return true;
+}
+
+// Queue the next record; the EE_READY interrupt writes it while loop() goes on
+static void journalCommit() {
+  eepromWriterFlush();  // pending_ may still be in use (only if commits come < 60 ms apart)
+  pending_.h.magic = SETTINGS_MAGIC;
+  pending_.h.version = SETTINGS_VERSION;
+  pending_.h.length = sizeof(Settings);
+  pending_.h.seq = headSeq_ + 1;
+  pending_.s = S;
+  pending_.h.crc = recordCrc(pending_.h, &pending_.s);
+  uint8_t slot = (headSlot_ + 1 < JOURNAL_SLOTS) ? headSlot_ + 1 : 0;
+  eepromWriterWrite(recordAddr(slot), &pending_, sizeof(pending_));
+  headSlot_ = slot;
+  headSeq_ = pending_.h.seq;
+}
+
 void saveSettings() {
-  S.crc = simple_crc(S);
-  EEPROM.put(0, S);
+  S.flags = (S.flags & ~FLAGS_ADC_EXTRA_MASK) | (ADC_EXTRA_BITS << FLAGS_ADC_EXTRA_SHIFT);
+  sensorCalRebuild();
+
+  // Written by settingsPoll() once the settings stop changing
+  dirty_ = true;
+  changedMs_ = millis();
+}
+
+void settingsPoll() {
+  eepromWriterPoll();
+  if (dirty_ && (uint32_t)(millis() - changedMs_) >= SETTINGS_COMMIT_DELAY_MS &&
+      !eepromWriterBusy()) {
+    settingsCommit();
+  }
+}
+
+void settingsCommit() {
+  if (!dirty_) return;
+  journalCommit();
+  dirty_ = false;
+}
+
+void settingsFlush() {
+  settingsCommit();
+  eepromWriterFlush();
+}
+
+bool settingsDirty() {
+  return dirty_;
+}
+
+bool settingsStored() {
+  return !dirty_ && !eepromWriterBusy();
+}
+
+// Convert calMin/calMax saved at another ADC resolution to ADC_EXTRA_BITS
+// (true if they changed), with the same rule as the calibration table
+static bool rescaleCalibration() {
+  uint8_t stored = (S.flags & FLAGS_ADC_EXTRA_MASK) >> FLAGS_ADC_EXTRA_SHIFT;
+  if (stored == ADC_EXTRA_BITS) return false;
+  S.calMin = adcRescale(S.calMin, stored);
+  S.calMax = adcRescale(S.calMax, stored);
+  return true;
 }
 
 void loadSettings() {
-  EEPROM.get(0, S);
-  
+  calTableLoad();
+  eepromWriterFlush();  // A rescaled table may be queued: finish it before reading on
+
+  // Newest current record, else an older layout (written as a current record below)
+  bool legacy = false;
+  bool bad = false;
+  if (!journalLoad(S, legacy)) {
+    legacy = loadV1(S) || loadV0(S);
+    bad = !legacy;                      // Nothing readable: first run or corrupted data
+  }
+
   // Validate loaded settings
-  bool bad =
-    (S.crc != simple_crc(S)) ||      // CRC mismatch = corrupted data
+  bool rescaled = !bad && rescaleCalibration();
+  bad = bad ||
     (S.calMin >= S.calMax) ||         // Invalid calibration range
-    (S.calMax > 1023) ||              // ADC max out of range
+    (S.calMax > ADC_MAX) ||           // ADC max out of range
     (S.zero100 >= 36000);             // Zero offset out of range
 
   if (bad) {
     // Load defaults if validation failed (first run or corrupted EEPROM)
     S.zero100 = 0;
     S.calMin  = 0;
-    S.calMax  = 1023;
+    S.calMax  = ADC_FULL_SCALE;
     S.flags   = 0;
     saveSettings();
+  } else if (rescaled || legacy) {
+    saveSettings();  // Store at the new resolution / in the current layout
+  } else {
+    sensorCalRebuild();
   }
 }
 
@@ -56,7 +265,7 @@ void doCalMin(uint16_t adc) {
   S.calMin = adc;
   if (S.calMin >= S.calMax) {
     S.calMax = S.calMin + 1;
-    if (S.calMax > 1023) S.calMax = 1023;
+    if (S.calMax > ADC_FULL_SCALE) S.calMax = ADC_FULL_SCALE;
   }
   saveSettings();
 }
@@ -3,24 +3,49 @@
 
 #include <Arduino.h>
 #include <EEPROM.h>
+#include "Config.h"
 
 // ---------------- Settings in EEPROM ----------------
+// Stored as a versioned record (Settings.cpp): new fields go at the end, with
+// SETTINGS_VERSION incremented
 struct Settings {
   uint16_t zero100;  // 0..35999 (0.01°)
-  uint16_t calMin;   // ADC raw min (0..1023)
-  uint16_t calMax;   // ADC raw max (0..1023)
-  uint8_t  flags;    // bit0 invert
-  uint8_t  crc;      // simple XOR crc
+  uint16_t calMin;   // ADC raw min (0..ADC_MAX)
+  uint16_t calMax;   // ADC raw max (0..ADC_MAX)
+  uint8_t  flags;    // bit0 invert, bits2-4 ADC_EXTRA_BITS of calMin/calMax
+  uint8_t  reserved; // 0, free for the next 8-bit field (no padding on any compiler)
 };
 
+// Resolution of the stored calibration values (settings written before oversampling: 0)
+static const uint8_t FLAGS_ADC_EXTRA_SHIFT = 2;
+static const uint8_t FLAGS_ADC_EXTRA_MASK  = 0x07 << FLAGS_ADC_EXTRA_SHIFT;
+static_assert((ADC_EXTRA_BITS << FLAGS_ADC_EXTRA_SHIFT) <= FLAGS_ADC_EXTRA_MASK,
+              "ADC_EXTRA_BITS does not fit the flags field");
+
 // Global settings instance
 extern Settings S;
 
-// Settings functions
-uint8_t simple_crc(const Settings& s);
+// Apply S (calibration transform) and schedule it for EEPROM: the write happens in
+// settingsPoll() after SETTINGS_COMMIT_DELAY_MS without further changes
 void saveSettings();
 void loadSettings();
 
+// Call from loop(): commits pending settings once they have been idle long enough
+// (and drives the EEPROM writer on boards without the EE_READY interrupt)
+void settingsPoll();
+
+// Queue pending settings for writing now (no-op if nothing changed); returns at once
+void settingsCommit();
+
+// Write pending settings and wait until they are in EEPROM (power fail)
+void settingsFlush();
+
+// True while S has changes not yet queued for writing
+bool settingsDirty();
+
+// True once S is completely in EEPROM: nothing pending, no EEPROM write in progress
+bool settingsStored();
+
 // Settings action functions
 void doSetValue(uint16_t raw100, uint16_t target100);
 void doSetZero(uint16_t raw100);
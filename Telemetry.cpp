@@ -0,0 +1,40 @@
+#include "Telemetry.h"
+
+#if defined(TELEMETRY)
+
+#include "Cobs.h"
+#include "Crc16.h"
+#include <stddef.h>
+
+static const uint8_t FRAME_BYTES = COBS_MAX_ENCODED(sizeof(TelemetryFrame)) + 1;  // + 0x00
+
+static uint16_t seq_ = 0;
+static uint16_t dropped_ = 0;
+
+void telemetryBegin() {
+  Serial.begin(TELEMETRY_BAUD);
+}
+
+bool telemetrySend(TelemetryFrame& f) {
+  f.seq = seq_++;
+  f.version = TELEMETRY_VERSION;
+  f.crc = crc16(&f, offsetof(TelemetryFrame, crc));
+
+  // HardwareSerial already has an interrupt-driven TX ring: write only if the whole
+  // frame fits, so Serial.write() never waits for the UART
+  if (Serial.availableForWrite() < FRAME_BYTES) {
+    dropped_++;
+    return false;
+  }
+  uint8_t buf[FRAME_BYTES];
+  uint8_t n = (uint8_t)cobsEncode((const uint8_t*)&f, sizeof(f), buf);
+  buf[n++] = 0;
+  Serial.write(buf, n);
+  return true;
+}
+
+uint16_t telemetryDropped() {
+  return dropped_;
+}
+
+#endif // TELEMETRY
@@ -0,0 +1,50 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <Arduino.h>
+#include "Config.h"
+
+// ---------------- Binary telemetry ----------------
+// With TELEMETRY defined (Config.h), one TelemetryFrame is sent every
+// TELEMETRY_PERIOD_MS on Serial at TELEMETRY_BAUD:
+//
+//   COBS(frame incl. CRC-16) 0x00
+//
+// The frame is little-endian with no padding (the same bytes on AVR and x86), so a
+// receiver can memcpy() it. The CRC-16 (Crc16.h) covers every byte before crc.
+// A frame is dropped rather than waited for when the Serial TX buffer has no room
+// for it; seq then shows the gap. host/telemetry decodes and records the stream.
+static const uint8_t TELEMETRY_VERSION = 1;
+
+// flags
+static const uint8_t TELEMETRY_FLAG_UNSAVED = 0x01;  // Settings not yet in EEPROM
+static const uint8_t TELEMETRY_FLAG_MOVING  = 0x02;  // Display tracker in its moving mode
+
+struct TelemetryFrame {
+  uint32_t timeUs;     // micros() when the values were taken
+  uint16_t seq;        // +1 per frame, including dropped ones
+  uint8_t  version;    // TELEMETRY_VERSION
+  uint8_t  flags;      // TELEMETRY_FLAG_*
+  uint16_t adc;        // Averaged ADC value (0..ADC_MAX)
+  uint16_t raw100;     // Calibrated angle without zero offset (0.01°)
+  uint16_t shown100;   // raw100 with the zero offset (0.01°)
+  uint16_t display100; // MAIN screen value after the display filter (0.01°)
+  int16_t  rate10;     // Angular rate (0.1 °/s)
+  uint16_t crc;        // CRC-16 of the bytes above
+};
+static_assert(sizeof(TelemetryFrame) == 20, "TelemetryFrame must have no padding");
+
+#if defined(TELEMETRY)
+
+// Start Serial at TELEMETRY_BAUD (call from setup())
+void telemetryBegin();
+
+// Fill in seq, version and crc of f and queue it; returns at once (false: dropped)
+bool telemetrySend(TelemetryFrame& f);
+
+// Frames dropped because the TX buffer was full
+uint16_t telemetryDropped();
+
+#endif // TELEMETRY
+
+#endif // TELEMETRY_H
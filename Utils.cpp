@@ -1,24 +1,95 @@
 #include "Utils.h"
+#include <string.h>
+
+// Centidegree -> arcminute table, evaluated by the compiler (100 bytes flash)
+// 1 centidegree = 0.6 arcminutes; rounding to nearest keeps the display stable:
+// 0->0, 1->1, 2->1, 3->2, 83->50, 84->50, 99->59 (never reaches 60)
+#define ARCMIN(c) (uint8_t)(((c) * 60 + 50) / 100)
+#define ARCMIN10(t) ARCMIN(t##0), ARCMIN(t##1), ARCMIN(t##2), ARCMIN(t##3), ARCMIN(t##4), \
+                    ARCMIN(t##5), ARCMIN(t##6), ARCMIN(t##7), ARCMIN(t##8), ARCMIN(t##9)
+static const uint8_t ARCMIN_TABLE[100] PROGMEM = {
+  ARCMIN(0), ARCMIN(1), ARCMIN(2), ARCMIN(3), ARCMIN(4),
+  ARCMIN(5), ARCMIN(6), ARCMIN(7), ARCMIN(8), ARCMIN(9),
+  ARCMIN10(1), ARCMIN10(2), ARCMIN10(3), ARCMIN10(4),
+  ARCMIN10(5), ARCMIN10(6), ARCMIN10(7), ARCMIN10(8), ARCMIN10(9)
+};
+#undef ARCMIN10
+#undef ARCMIN
+
+// "00".."99" digit pairs: two digits per lookup instead of a division by 10 (200 bytes flash)
+#define DPAIR10(t) #t "0" #t "1" #t "2" #t "3" #t "4" #t "5" #t "6" #t "7" #t "8" #t "9"
+static const char DIGIT_PAIRS[201] PROGMEM =
+  DPAIR10(0) DPAIR10(1) DPAIR10(2) DPAIR10(3) DPAIR10(4)
+  DPAIR10(5) DPAIR10(6) DPAIR10(7) DPAIR10(8) DPAIR10(9);
+#undef DPAIR10
+
+// Place values for num(); the last digit is what remains after subtracting these
+static const uint16_t POW10[4] PROGMEM = { 10000, 1000, 100, 10 };
+
+uint8_t centiToArcmin(uint8_t centi) {
+  return pgm_read_byte(&ARCMIN_TABLE[centi]);
+}
+
+LineWriter::LineWriter(char* dst, uint8_t width) : dst_(dst), width_(width), len_(0) {
+  memset(dst_, ' ', width_);
+  dst_[width_] = 0;
+}
+
+LineWriter& LineWriter::ch(char c) {
+  if (len_ < width_) dst_[len_++] = c;
+  return *this;
+}
+
+LineWriter& LineWriter::text(const char* s) {
+  while (*s && len_ < width_) dst_[len_++] = *s++;
+  return *this;
+}
+
+LineWriter& LineWriter::text(const __FlashStringHelper* s) {
+  const char* p = reinterpret_cast<const char*>(s);
+  char c;
+  while (len_ < width_ && (c = pgm_read_byte(p++)) != 0) dst_[len_++] = c;
+  return *this;
+}
+
+LineWriter& LineWriter::num(uint16_t v, uint8_t minWidth, char pad) {
+  // Digits by repeated subtraction of place values (no division on AVR)
+  char digits[5];
+  uint8_t n = 0;
+  for (uint8_t i = 0; i < 4; i++) {
+    uint16_t p = pgm_read_word(&POW10[i]);
+    char d = '0';
+    while (v >= p) { v -= p; d++; }
+    if (d != '0' || n != 0) digits[n++] = d;
+  }
+  digits[n++] = '0' + (char)v;
+
+  while (minWidth > n) { ch(pad); minWidth--; }
+  for (uint8_t i = 0; i < n; i++) ch(digits[i]);
+  return *this;
+}
+
+LineWriter& LineWriter::angle(uint16_t a100) {
+  // a100 / 100 as multiply-shift: exact for a100 < 43699
+  uint16_t deg = (uint16_t)(((uint32_t)a100 * 5243UL) >> 19);  // Whole degrees (0..359)
+  uint8_t centi = (uint8_t)(a100 - deg * 100);                 // Remaining centidegrees (0..99)
+  uint8_t min = centiToArcmin(centi);
+
+  // "%3u": hundreds digit or space, then the two low digits (space-padded below 10)
+  uint8_t hundreds = (uint8_t)((deg * 41U) >> 12);              // deg / 100 for deg < 1000
+  uint8_t rest = (uint8_t)(deg - hundreds * 100);
+  ch(hundreds ? (char)('0' + hundreds) : ' ');
+  ch((hundreds || rest >= 10) ? (char)pgm_read_byte(&DIGIT_PAIRS[rest * 2]) : ' ');
+  ch((char)pgm_read_byte(&DIGIT_PAIRS[rest * 2 + 1]));
+
+  // "%c%02u'"
+  ch(LCD_DEGREE_CHAR);
+  ch((char)pgm_read_byte(&DIGIT_PAIRS[min * 2]));
+  ch((char)pgm_read_byte(&DIGIT_PAIRS[min * 2 + 1]));
+  ch('\'');
+  return *this;
+}
 
 void formatAngle100(char* out, uint16_t a100) {
-  // Convert from centidegrees (0..35999) to degrees and minutes
-  // Format: "359°59'" (degrees and arcminutes)
-  // Using byte 0xDF (223) which is degree symbol (°) in HD44780 LCD character ROM
-  uint16_t deg = a100 / 100;              // Whole degrees (0..359)
-  uint16_t centidegrees = a100 % 100;     // Remaining centidegrees (0..99)
-  
-  // Convert centidegrees to arcminutes: 1 centidegree = 0.01° = 0.6 arcminutes
-  // Formula: minutes = centidegrees * 60 / 100
-  // For stable display: use proper rounding with consistent algorithm
-  // Standard rounding: (value * 60 + 50) / 100 rounds to nearest integer
-  // Examples: 0→0, 1→1, 2→1, 3→2, 83→50, 84→50, 99→59
-  uint32_t minutes_scaled = (uint32_t)centidegrees * 60UL;  // Avoid overflow: max 99 * 60 = 5940
-  // Round to nearest: add 50 before dividing by 100
-  // This ensures: 0.0-0.49 → 0, 0.5-1.49 → 1, 1.5-2.49 → 2, etc.
-  uint8_t min = (uint8_t)((minutes_scaled + 50UL) / 100UL);
-  if (min >= 60) min = 59;  // Clamp to 59 (safety check - shouldn't happen with centidegrees <= 99)
-  
-  // Format: "359°59'" (7 chars: 3 digits + degree symbol + 2 digits + apostrophe)
-  sprintf(out, "%3u%c%02u'", deg, (char)0xDF, min);
-  out[8] = 0;  // Ensure null terminator (safety)
+  LineWriter(out, 7).angle(a100);  // Exactly 7 chars + terminator
 }
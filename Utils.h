@@ -3,8 +3,40 @@
 
 #include <Arduino.h>
 
+// ---------------- Fixed-layout text formatting (no printf) ----------------
+// Degree symbol in the HD44780 character ROM
+#define LCD_DEGREE_CHAR ((char)0xDF)
+
+// Centidegrees (0..99) to arcminutes, rounded to nearest: (c * 60 + 50) / 100
+uint8_t centiToArcmin(uint8_t centi);
+
+// Writes text into a fixed-width line buffer: the line starts blank (spaces,
+// terminated at width), output beyond width is dropped like snprintf truncation
+class LineWriter {
+public:
+  LineWriter(char* dst, uint8_t width);
+
+  LineWriter& text(const char* s);
+  LineWriter& text(const __FlashStringHelper* s);  // F("...") / PROGMEM string
+  LineWriter& ch(char c);
+
+  // Unsigned decimal, right-aligned in minWidth with pad (' ' = "%5u", '0' = "%05u")
+  LineWriter& num(uint16_t v, uint8_t minWidth = 0, char pad = ' ');
+
+  // Angle from centidegrees as "359°59'" (same output as formatAngle100)
+  LineWriter& angle(uint16_t a100);
+
+  uint8_t length() const { return len_; }
+
+private:
+  char* dst_;
+  uint8_t width_;
+  uint8_t len_;
+};
+
 // Format angle from centidegrees (0..35999) to string "359°59'" (degrees and arcminutes)
 // Example: 35999 -> "359°59'", 12345 -> "123°27'", 1234 -> " 12°20'"
+// out must hold 8 chars
 void formatAngle100(char* out, uint16_t a100);
 
 #endif // UTILS_H
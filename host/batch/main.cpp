@@ -0,0 +1,419 @@
+// ---------------- Batch log processing ----------------
+// Converts archived ADC logs to displayed angles with the firmware's own conversion and
+// MAIN screen filter, on all cores, e.g. to reprocess a unit's history after a
+// calibration fix.
+//
+//   p3022_batch [--eeprom FILE] [--zero DEG] [--cal MIN:MAX] [--invert 0|1] [--adc-bits N]
+//               [--format u16|text] [--threads N] [--chunk N] [--warmup N] [--check]
+//               [--angles FILE] [--stats FILE] LOG
+//
+// LOG        One averaged ADC value per sample (one per ADC block):
+//              u16   little-endian uint16 (default; memory-mapped, any size)
+//              text  one decimal value per line, '#' comments (parsed into memory first)
+// --eeprom   Settings/calibration of the unit (default: defaults); --zero, --cal and
+//            --invert then override single values (--cal in ADC_MAX units)
+// --adc-bits Resolution of the log values if not ADC_BITS (e.g. 10 for old logs)
+// --angles   Displayed angle per sample: little-endian uint16, centidegrees (0..35999)
+// --stats    Summary and 1° histogram of the displayed angle (default: stdout)
+// --check    Also convert and filter the whole log with the scalar functions on one
+//            thread and compare (for testing)
+//
+// The log is cut into --chunk samples (default 4M) that a pool of --threads workers
+// (default: all cores) converts (adcToShown100Batch) and filters independently. The
+// filter has state, so a chunk's filter is first warmed up on the --warmup samples
+// before it (default 2048). Its outputs are exact once its state equals that of a
+// filter that saw the whole log from the start; each seam is then checked in order: a
+// filter carried over from the previous chunk re-filters the chunk's first samples
+// until the two states are equal (usually a small part of the chunk; one that never
+// converges is re-filtered whole), so the result is identical to one pass.
+
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "SimHal.h"
+#include "P3022-CW360-Batton_V1.2.ino"
+#include "AngleBatch.h"
+
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "u16 logs are mapped as host uint16");
+
+namespace {
+
+// ---------------- Memory-mapped files ----------------
+struct Mapping {
+  void* data = MAP_FAILED;
+  size_t size = 0;
+
+  ~Mapping() {
+    if (data != MAP_FAILED) munmap(data, size);
+  }
+};
+
+bool mapInput(const char* path, Mapping& m) {
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) return false;
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size == 0) {
+    close(fd);
+    return false;
+  }
+  m.size = (size_t)st.st_size;
+  m.data = mmap(nullptr, m.size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (m.data == MAP_FAILED) return false;
+  madvise(m.data, m.size, MADV_SEQUENTIAL);
+  return true;
+}
+
+// Output file of the given size (or anonymous memory without a path)
+bool mapOutput(const char* path, size_t size, Mapping& m) {
+  m.size = size;
+  if (!path) {
+    m.data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    return m.data != MAP_FAILED;
+  }
+  int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) return false;
+  if (ftruncate(fd, (off_t)size) != 0) {
+    close(fd);
+    return false;
+  }
+  m.data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  return m.data != MAP_FAILED;
+}
+
+// ---------------- Worker pool ----------------
+// Runs job(0..jobs-1) on up to `threads` threads, each taking the next free index
+template <class Job>
+void runParallel(size_t jobs, unsigned threads, const Job& job) {
+  std::atomic<size_t> next(0);
+  auto worker = [&]() {
+    for (size_t i = next++; i < jobs; i = next++) job(i);
+  };
+  std::vector<std::thread> pool;
+  for (unsigned t = 1; t < threads && t < jobs; t++) pool.emplace_back(worker);
+  worker();
+  for (std::thread& t : pool) t.join();
+}
+
+// ---------------- Text logs ----------------
+// Values of the lines in [p, end) (lines without a leading number are skipped)
+void parseText(const char* p, const char* end, std::vector<uint16_t>& out) {
+  while (p < end) {
+    while (p < end && (*p == ' ' || *p == '\t')) p++;
+    if (p < end && *p >= '0' && *p <= '9') {
+      uint32_t v = 0;
+      while (p < end && *p >= '0' && *p <= '9') v = (v < 100000) ? v * 10 + (*p++ - '0') : v;
+      out.push_back((uint16_t)(v > 0xFFFF ? 0xFFFF : v));
+    }
+    const char* nl = (const char*)memchr(p, '\n', end - p);
+    p = nl ? nl + 1 : end;
+  }
+}
+
+// Splits the text at line ends into ~chunkBytes pieces parsed in parallel
+void loadText(const Mapping& m, size_t chunkBytes, unsigned threads, std::vector<uint16_t>& out) {
+  const char* base = (const char*)m.data;
+  const char* end = base + m.size;
+  std::vector<const char*> cuts(1, base);
+  while (cuts.back() < end) {
+    const char* c = cuts.back() + std::min(chunkBytes, (size_t)(end - cuts.back()));
+    const char* nl = (c < end) ? (const char*)memchr(c, '\n', end - c) : nullptr;
+    cuts.push_back(nl ? nl + 1 : end);
+  }
+  std::vector<std::vector<uint16_t> > parts(cuts.size() - 1);
+  runParallel(parts.size(), threads, [&](size_t k) { parseText(cuts[k], cuts[k + 1], parts[k]); });
+  size_t n = 0;
+  for (const std::vector<uint16_t>& p : parts) n += p.size();
+  out.reserve(n);
+  for (const std::vector<uint16_t>& p : parts) out.insert(out.end(), p.begin(), p.end());
+}
+
+// ---------------- Conversion + filter ----------------
+static const size_t BLOCK = 4096;  // Samples converted per adcToShown100Batch() call
+
+struct Pipeline {
+  const uint16_t* adc;  // Log values
+  uint16_t* shown;      // Displayed angle per sample
+  int8_t adcShift;      // Log value -> ADC_MAX scale: << (> 0) or >> (< 0)
+  const AngleBatchContext* ctx;
+
+  // Same rule as adcRescale() for stored calibration values (centre of the codes)
+  uint16_t scaled(size_t i) const {
+    uint32_t v = adc[i];
+    if (adcShift > 0) v = (v << adcShift) + (1U << (adcShift - 1));
+    else if (adcShift < 0) v >>= -adcShift;
+    return (uint16_t)(v > ADC_FULL_SCALE ? ADC_FULL_SCALE : v);
+  }
+
+  uint16_t input(size_t i) const { return adcToShown100(scaled(i)); }
+
+  // input() of samples [first, first + len), len <= BLOCK
+  void convert(size_t first, size_t len, uint16_t* out) const {
+    if (adcShift == 0) {
+      adcToShown100Batch(*ctx, adc + first, out, len);
+      return;
+    }
+    uint16_t tmp[BLOCK];
+    for (size_t i = 0; i < len; i++) tmp[i] = scaled(first + i);
+    adcToShown100Batch(*ctx, tmp, out, len);
+  }
+};
+
+struct Chunk {
+  size_t begin, end;
+  DisplayFilter start;  // After the warm-up, before begin
+  DisplayFilter last;   // After end - 1
+};
+
+// Per chunk, merged in chunk order (same sums for any thread count)
+struct Stats {
+  uint64_t n = 0;
+  uint16_t adcMin = 0xFFFF, adcMax = 0;
+  uint64_t adcSum = 0;
+  double sinSum = 0, cosSum = 0;
+  uint64_t hist[360] = {};
+
+  void add(const Stats& o) {
+    n += o.n;
+    adcMin = std::min(adcMin, o.adcMin);
+    adcMax = std::max(adcMax, o.adcMax);
+    adcSum += o.adcSum;
+    sinSum += o.sinSum;
+    cosSum += o.cosSum;
+    for (int d = 0; d < 360; d++) hist[d] += o.hist[d];
+  }
+};
+
+void usage() {
+  fprintf(stderr,
+          "usage: p3022_batch [--eeprom FILE] [--zero DEG] [--cal MIN:MAX] [--invert 0|1] [--adc-bits N]\n"
+          "                   [--format u16|text] [--threads N] [--chunk N] [--warmup N] [--check]\n"
+          "                   [--angles FILE] [--stats FILE] LOG\n");
+}
+
+double secondsSince(std::chrono::steady_clock::time_point t) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - t).count();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  const char* eepromPath = nullptr;
+  const char* anglesPath = nullptr;
+  const char* statsPath = nullptr;
+  const char* logPath = nullptr;
+  bool text = false;
+  bool check = false;
+  double zeroDeg = -1;
+  long calMin = -1, calMax = -1;
+  int invert = -1;
+  int adcBits = ADC_BITS;
+  unsigned threads = std::thread::hardware_concurrency();
+  size_t chunkSize = 1 << 22;
+  size_t warmup = 2048;
+
+  for (int i = 1; i < argc; i++) {
+    std::string a = argv[i];
+    bool hasNext = i + 1 < argc;
+    if (a == "--eeprom" && hasNext) eepromPath = argv[++i];
+    else if (a == "--zero" && hasNext) zeroDeg = atof(argv[++i]);
+    else if (a == "--cal" && hasNext) {
+      if (sscanf(argv[++i], "%ld:%ld", &calMin, &calMax) != 2) { usage(); return 2; }
+    }
+    else if (a == "--invert" && hasNext) invert = atoi(argv[++i]);
+    else if (a == "--adc-bits" && hasNext) adcBits = atoi(argv[++i]);
+    else if (a == "--format" && hasNext) {
+      std::string f = argv[++i];
+      if (f != "u16" && f != "text") { usage(); return 2; }
+      text = (f == "text");
+    }
+    else if (a == "--threads" && hasNext) threads = (unsigned)atoi(argv[++i]);
+    else if (a == "--chunk" && hasNext) chunkSize = (size_t)atoll(argv[++i]);
+    else if (a == "--warmup" && hasNext) warmup = (size_t)atoll(argv[++i]);
+    else if (a == "--check") check = true;
+    else if (a == "--angles" && hasNext) anglesPath = argv[++i];
+    else if (a == "--stats" && hasNext) statsPath = argv[++i];
+    else if (!logPath && a[0] != '-') logPath = argv[i];
+    else { usage(); return 2; }
+  }
+  if (!logPath || chunkSize == 0 || adcBits < 8 || adcBits > 16 || zeroDeg >= 360 ||
+      (calMin >= 0 && (calMin >= calMax || calMax > ADC_MAX))) {
+    usage();
+    return 2;
+  }
+  if (threads == 0) threads = 1;
+
+  // Settings as the unit had them, then the overrides
+  sim::reset();
+  if (eepromPath) sim::eepromLoad(eepromPath);
+  loadSettings();
+  if (zeroDeg >= 0) S.zero100 = (uint16_t)(zeroDeg * 100 + 0.5) % 36000;
+  if (calMin >= 0) {
+    S.calMin = (uint16_t)calMin;
+    S.calMax = (uint16_t)calMax;
+  }
+  if (invert >= 0) S.flags = invert ? (S.flags | 0x01) : (S.flags & ~0x01);
+  sensorCalRebuild();
+
+  typedef std::chrono::steady_clock Clock;
+  Clock::time_point t0 = Clock::now();
+  Mapping in;
+  errno = 0;
+  if (!mapInput(logPath, in)) {
+    fprintf(stderr, "cannot map %s: %s\n", logPath, errno ? strerror(errno) : "empty file");
+    return 1;
+  }
+  std::vector<uint16_t> parsed;
+  Pipeline pipe;
+  size_t n;
+  if (text) {
+    loadText(in, chunkSize * 6, threads, parsed);
+    pipe.adc = parsed.data();
+    n = parsed.size();
+    fprintf(stderr, "parsed %zu values in %.2f s\n", n, secondsSince(t0));
+  } else {
+    if (in.size & 1) fprintf(stderr, "warning: odd file size, last byte ignored\n");
+    pipe.adc = (const uint16_t*)in.data;
+    n = in.size / 2;
+  }
+  if (n == 0) {
+    fprintf(stderr, "no samples in %s\n", logPath);
+    return 1;
+  }
+  pipe.adcShift = (int8_t)(ADC_BITS - adcBits);
+  static AngleBatchContext ctx;  // ADC_MAX + 1 words
+  angleBatchInit(ctx);
+  pipe.ctx = &ctx;
+
+  Mapping outMap;
+  if (!mapOutput(anglesPath, n * 2, outMap)) {
+    fprintf(stderr, "cannot write %s: %s\n", anglesPath ? anglesPath : "(memory)", strerror(errno));
+    return 1;
+  }
+  pipe.shown = (uint16_t*)outMap.data;
+
+  std::vector<Chunk> chunks;
+  for (size_t b = 0; b < n; b += chunkSize) {
+    chunks.push_back(Chunk());
+    chunks.back().begin = b;
+    chunks.back().end = std::min(n, b + chunkSize);
+  }
+
+  // ---------------- Pass 1: chunks in parallel, each from a warmed-up filter ----------------
+  Clock::time_point t1 = Clock::now();
+  runParallel(chunks.size(), threads, [&](size_t k) {
+    Chunk& c = chunks[k];
+    DisplayFilter f;
+    for (size_t i = (c.begin > warmup) ? c.begin - warmup : 0; i < c.begin; i++) f.process(pipe.input(i));
+    c.start = f;
+    // Convert a block at a time (vectorized), then filter it in place
+    for (size_t b = c.begin; b < c.end; b += BLOCK) {
+      size_t len = std::min(BLOCK, c.end - b);
+      uint16_t* out = pipe.shown + b;
+      pipe.convert(b, len, out);
+      for (size_t i = 0; i < len; i++) out[i] = f.process(out[i]);
+    }
+    c.last = f;
+  });
+  double pass1 = secondsSince(t1);
+
+  // ---------------- Pass 2: seams, in order ----------------
+  // carried = state after the previous chunk as one pass over the log would have it
+  Clock::time_point t2 = Clock::now();
+  DisplayFilter carried = chunks[0].last;
+  size_t refiltered = 0, longest = 0, unconverged = 0;
+  for (size_t k = 1; k < chunks.size(); k++) {
+    Chunk& c = chunks[k];
+    DisplayFilter warm = c.start;
+    size_t i = c.begin;
+    while (i < c.end && !carried.sameState(warm)) {
+      uint16_t a = pipe.input(i);
+      pipe.shown[i++] = carried.process(a);
+      warm.process(a);
+    }
+    refiltered += i - c.begin;
+    longest = std::max(longest, i - c.begin);
+    if (i < c.end) carried = c.last;
+    else unconverged++;  // Whole chunk re-filtered: carried is already its end state
+  }
+  double pass2 = secondsSince(t2);
+
+  // ---------------- Pass 3: statistics ----------------
+  Clock::time_point t3 = Clock::now();
+  std::vector<double> sinTable(36000), cosTable(36000);  // For the circular mean
+  for (int a = 0; a < 36000; a++) {
+    sinTable[a] = sin(a * M_PI / 18000);
+    cosTable[a] = cos(a * M_PI / 18000);
+  }
+  std::vector<Stats> parts(chunks.size());
+  runParallel(chunks.size(), threads, [&](size_t k) {
+    Stats& s = parts[k];
+    for (size_t i = chunks[k].begin; i < chunks[k].end; i++) {
+      uint16_t adc = pipe.scaled(i);
+      uint16_t a = pipe.shown[i];
+      s.n++;
+      s.adcMin = std::min(s.adcMin, adc);
+      s.adcMax = std::max(s.adcMax, adc);
+      s.adcSum += adc;
+      s.hist[a / 100]++;
+      s.sinSum += sinTable[a];
+      s.cosSum += cosTable[a];
+    }
+  });
+  Stats total;
+  for (const Stats& s : parts) total.add(s);
+  double pass3 = secondsSince(t3);
+  double wall = secondsSince(t0);
+
+  fprintf(stderr, "%zu samples, %zu chunks, %u threads: %.2f s (%.1f Msamples/s)\n", n, chunks.size(),
+          threads, wall, n / wall / 1e6);
+  fprintf(stderr, "  chunks %.2f s, seams %.3f s (%zu samples re-filtered, longest %zu, %zu not converged), "
+          "stats %.2f s\n", pass1, pass2, refiltered, longest, unconverged, pass3);
+
+  int rc = 0;
+  if (check) {
+    Clock::time_point tc = Clock::now();
+    DisplayFilter f;
+    size_t bad = 0, firstBad = 0;
+    for (size_t i = 0; i < n; i++) {
+      if (f.process(pipe.input(i)) != pipe.shown[i] && bad++ == 0) firstBad = i;
+    }
+    if (bad) {
+      fprintf(stderr, "check: %zu samples differ from one pass, first at %zu\n", bad, firstBad);
+      rc = 1;
+    } else {
+      fprintf(stderr, "check: identical to one pass (%.2f s on one thread)\n", secondsSince(tc));
+    }
+  }
+
+  FILE* out = statsPath ? fopen(statsPath, "w") : stdout;
+  if (!out) {
+    fprintf(stderr, "cannot write %s\n", statsPath);
+    return 1;
+  }
+  double mean = atan2(total.sinSum, total.cosSum) * 180 / M_PI;
+  double r = sqrt(total.sinSum * total.sinSum + total.cosSum * total.cosSum) / total.n;
+  fprintf(out, "# p3022_batch: %s\n", logPath);
+  fprintf(out, "settings: zero %.2f deg, cal %u..%u, flags 0x%02X, cal table %s\n", S.zero100 / 100.0,
+          S.calMin, S.calMax, S.flags, calTableActive() ? "on" : "off");
+  fprintf(out, "samples %zu (%.1f h at one per ADC block)\n", n, n * (ADC_BLOCK_US / 3.6e9));
+  fprintf(out, "adc min %u max %u mean %.2f\n", total.adcMin, total.adcMax, (double)total.adcSum / total.n);
+  fprintf(out, "angle mean %.2f deg, circular spread %.2f deg\n", mean < 0 ? mean + 360 : mean,
+          r >= 1 ? 0.0 : sqrt(-2 * log(r)) * 180 / M_PI);
+  fprintf(out, "## histogram (deg, samples)\n");
+  for (int d = 0; d < 360; d++) {
+    if (total.hist[d]) fprintf(out, "%d %llu\n", d, (unsigned long long)total.hist[d]);
+  }
+  if (out != stdout) fclose(out);
+  return rc;
+}
@@ -0,0 +1,68 @@
+#include "AngleBatch.h"
+
+void angleBatchInit(AngleBatchContext& ctx) {
+  CalTransform t;
+  ctx.table = sensorCalTransform(t);
+  ctx.calMin = t.calMin;
+  ctx.calMax = t.calMax;
+  ctx.mult = t.mult;
+  ctx.base = t.base;
+  ctx.invert = t.invert ? 1 : 0;
+  if (ctx.table) {
+    for (uint32_t adc = 0; adc <= ADC_MAX; adc++) ctx.lut[adc] = adcToAngle100((uint16_t)adc);
+  }
+}
+
+// The line's constants as locals: loads from the context inside the selects would keep
+// the compiler from turning them into vector blends
+struct Line {
+  uint32_t lo, hi, mult, invert;
+};
+
+static inline Line lineOf(const AngleBatchContext& c) {
+  Line l = { c.calMin, c.calMax, c.mult, c.invert };
+  return l;
+}
+
+// Same steps as calScale() + inversion in Sensor.cpp, as selects instead of branches.
+// Every value is uint32_t so the compiler keeps one lane width through the loop.
+static inline uint32_t lineAngle(const Line& l, uint32_t x) {
+  x = (x < l.lo) ? l.lo : x;
+  x = (x > l.hi) ? l.hi : x;
+  uint32_t a = ((x - l.lo) * l.mult) >> 16;  // < 2^32: see Sensor.cpp
+  a = (a >= 36000) ? 0 : a;
+  return (l.invert & (a != 0)) ? 36000 - a : a;
+}
+
+// Any code above ADC_MAX converts like ADC_MAX (the line clamps it to calMax, and the
+// table maps everything from its last point on to 0)
+static inline uint32_t lutAngle(const AngleBatchContext& c, uint32_t x) {
+  return c.lut[(x > ADC_MAX) ? ADC_MAX : x];
+}
+
+// (angle - zero) mod 36000 = (angle + base) mod 36000, base in 1..36000
+static inline uint32_t shown(uint32_t base, uint32_t a) {
+  uint32_t v = a + base;
+  return (v >= 36000) ? v - 36000 : v;
+}
+
+void adcToAngle100Batch(const AngleBatchContext& ctx, const uint16_t* __restrict__ adc,
+                        uint16_t* __restrict__ angle100, size_t n) {
+  if (ctx.table) {
+    for (size_t i = 0; i < n; i++) angle100[i] = (uint16_t)lutAngle(ctx, adc[i]);
+  } else {
+    const Line l = lineOf(ctx);
+    for (size_t i = 0; i < n; i++) angle100[i] = (uint16_t)lineAngle(l, adc[i]);
+  }
+}
+
+void adcToShown100Batch(const AngleBatchContext& ctx, const uint16_t* __restrict__ adc,
+                        uint16_t* __restrict__ shown100, size_t n) {
+  const uint32_t base = ctx.base;
+  if (ctx.table) {
+    for (size_t i = 0; i < n; i++) shown100[i] = (uint16_t)shown(base, lutAngle(ctx, adc[i]));
+  } else {
+    const Line l = lineOf(ctx);
+    for (size_t i = 0; i < n; i++) shown100[i] = (uint16_t)shown(base, lineAngle(l, adc[i]));
+  }
+}
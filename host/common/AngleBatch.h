@@ -0,0 +1,40 @@
+#ifndef ANGLEBATCH_H
+#define ANGLEBATCH_H
+
+#include <Arduino.h>
+#include "Config.h"
+#include "Sensor.h"
+
+// ---------------- Batch ADC -> angle conversion ----------------
+// adcToAngle100() and adcToShown100() for arrays of samples, for the host tools that
+// convert whole logs (host/replay, host/batch). The calibration is captured once into a
+// context instead of being read per call, and the two-point line is written as
+// branch-free arithmetic on 32-bit lanes with no state carried between samples, so the
+// compiler vectorizes the loop (x86: 4 samples per instruction with SSE2, 8 with AVX2).
+// While the calibration table is in use, the context holds the angle of every ADC code
+// instead (one lookup per sample).
+//
+// Results are identical to the scalar functions for every input value (0..65535).
+// The context is ADC_MAX + 1 words: host only (not part of the sketch), not for the 2 KB
+// RAM boards.
+
+struct AngleBatchContext {
+  uint32_t calMin;
+  uint32_t calMax;
+  uint32_t mult;
+  uint32_t base;    // 36000 - zero100
+  uint32_t invert;  // 0 or 1
+  bool table;       // Convert through lut[] instead of the line
+  uint16_t lut[ADC_MAX + 1];  // adcToAngle100() of every code while table is set
+};
+
+// Capture the current calibration (settings + table); again after either changes
+void angleBatchInit(AngleBatchContext& ctx);
+
+// angle100[i] = adcToAngle100(adc[i]) for i < n (arrays must not overlap)
+void adcToAngle100Batch(const AngleBatchContext& ctx, const uint16_t* adc, uint16_t* angle100, size_t n);
+
+// shown100[i] = adcToShown100(adc[i]) for i < n (arrays must not overlap)
+void adcToShown100Batch(const AngleBatchContext& ctx, const uint16_t* adc, uint16_t* shown100, size_t n);
+
+#endif // ANGLEBATCH_H
@@ -0,0 +1,102 @@
+#ifndef ARDUINO_H
+#define ARDUINO_H
+
+// ---------------- Host HAL: Arduino core ----------------
+// Minimal stand-in for the AVR Arduino core so the sketch sources compile on Linux.
+// Time is virtual (see SimHal.h): millis()/micros() only move when the simulation
+// advances the clock or the sketch calls delay()/delayMicroseconds().
+// __AVR__ is never defined here, so register-level code paths use their portable fallbacks.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "Print.h"
+
+#ifndef F_CPU
+  #define F_CPU 16000000UL
+#endif
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH 0x1
+#define LOW  0x0
+
+#define INPUT        0x0
+#define OUTPUT       0x1
+#define INPUT_PULLUP 0x2
+
+#define CHANGE  1
+#define FALLING 2
+#define RISING  3
+
+#define DEFAULT  1
+#define EXTERNAL 0
+
+#define NUM_DIGITAL_PINS 24
+#define NUM_ANALOG_INPUTS 6
+
+static const uint8_t A0 = 14;
+static const uint8_t A1 = 15;
+static const uint8_t A2 = 16;
+static const uint8_t A3 = 17;
+static const uint8_t A4 = 18;
+static const uint8_t A5 = 19;
+
+// Program memory is ordinary memory on the host
+#define PROGMEM
+#define PSTR(s) (s)
+#define F(s) (reinterpret_cast<const __FlashStringHelper*>(s))
+#define pgm_read_byte(addr)  (*(const uint8_t*)(addr))
+#define pgm_read_word(addr)  (*(const uint16_t*)(addr))
+#define pgm_read_dword(addr) (*(const uint32_t*)(addr))
+#define memcpy_P memcpy
+#define strcpy_P strcpy
+#define strlen_P strlen
+
+// Time (virtual clock)
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+void delayMicroseconds(unsigned int us);
+
+// Digital / analog I/O (scriptable through SimHal.h)
+void pinMode(uint8_t pin, uint8_t mode);
+int digitalRead(uint8_t pin);
+void digitalWrite(uint8_t pin, uint8_t val);
+int analogRead(uint8_t pin);
+void analogReference(uint8_t mode);
+
+// Interrupts: the simulation is single-threaded, so masking is a no-op
+inline void noInterrupts() {}
+inline void interrupts() {}
+#define digitalPinToInterrupt(p) ((p) == 2 ? 0 : ((p) == 3 ? 1 : -1))
+void attachInterrupt(int8_t num, void (*isr)(), int mode);
+void detachInterrupt(int8_t num);
+
+// Serial port: output goes to the simulation's serial sink, input is injected by scripts
+class HardwareSerial : public Print {
+public:
+  void begin(unsigned long baud);
+  void end() {}
+  int available();
+  int read();
+  int peek();
+  int availableForWrite();
+  void flush() {}
+  size_t write(uint8_t c);
+  using Print::write;
+  operator bool() const { return true; }
+};
+
+extern HardwareSerial Serial;
+
+// Entry points defined by the sketch
+void setup();
+void loop();
+
+#endif // ARDUINO_H
@@ -0,0 +1,46 @@
+#ifndef EEPROM_H
+#define EEPROM_H
+
+// ---------------- Host HAL: EEPROM ----------------
+// 1 KB EEPROM image (ATmega328P/32U4 size) kept in memory; SimHal.h can load/save it
+// to a file and exposes per-cell write counters for wear measurements.
+
+#include <Arduino.h>
+
+#ifndef E2END
+  #define E2END 0x3FF
+#endif
+
+namespace sim {
+  uint8_t* eepromData();
+  void eepromNoteWrite(int idx);
+}
+
+class EEPROMClass {
+public:
+  uint8_t read(int idx) { return sim::eepromData()[idx & E2END]; }
+  void write(int idx, uint8_t val) {
+    sim::eepromData()[idx & E2END] = val;
+    sim::eepromNoteWrite(idx & E2END);
+  }
+  void update(int idx, uint8_t val) {
+    if (read(idx) != val) write(idx, val);
+  }
+  uint16_t length() { return E2END + 1; }
+
+  template <typename T> T& get(int idx, T& t) {
+    uint8_t* p = (uint8_t*)&t;
+    for (size_t i = 0; i < sizeof(T); i++) p[i] = read(idx + (int)i);
+    return t;
+  }
+  // Same as the AVR library: only changed bytes are written
+  template <typename T> const T& put(int idx, const T& t) {
+    const uint8_t* p = (const uint8_t*)&t;
+    for (size_t i = 0; i < sizeof(T); i++) update(idx + (int)i, p[i]);
+    return t;
+  }
+};
+
+extern EEPROMClass EEPROM;
+
+#endif // EEPROM_H
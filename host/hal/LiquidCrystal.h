@@ -0,0 +1,26 @@
+#ifndef LIQUIDCRYSTAL_H
+#define LIQUIDCRYSTAL_H
+
+// ---------------- Host HAL: LiquidCrystal (4-bit parallel) ----------------
+
+#include <Arduino.h>
+#include "SimHal.h"
+
+class LiquidCrystal : public sim::LcdModel {
+public:
+  LiquidCrystal(uint8_t rs, uint8_t enable, uint8_t d4, uint8_t d5, uint8_t d6, uint8_t d7)
+    : rs_(rs), enable_(enable) { (void)d4; (void)d5; (void)d6; (void)d7; }
+
+  void begin(uint8_t cols, uint8_t rows) {
+    pinMode(rs_, OUTPUT);
+    pinMode(enable_, OUTPUT);
+    configure(cols, rows);
+    delayMicroseconds(50000);  // Power-on wait done by the real library
+    sim::setActiveLcd(this);
+  }
+
+private:
+  uint8_t rs_, enable_;
+};
+
+#endif // LIQUIDCRYSTAL_H
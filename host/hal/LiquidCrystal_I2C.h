@@ -0,0 +1,73 @@
+#ifndef LIQUIDCRYSTAL_I2C_H
+#define LIQUIDCRYSTAL_I2C_H
+
+// ---------------- Host HAL: LiquidCrystal_I2C (PCF8574 backpack) ----------------
+// Reproduces the library's bus pattern: one Wire transaction per expander write
+// (nibble, enable high, enable low) with its fixed delays. The simulated PCF8574 in
+// SimHal decodes the traffic, so sim::lcd() shows the result.
+
+#include <Arduino.h>
+#include <Wire.h>
+#include "SimHal.h"
+
+class LiquidCrystal_I2C : public Print {
+public:
+  LiquidCrystal_I2C(uint8_t addr, uint8_t cols, uint8_t rows)
+    : addr_(addr), cols_(cols), rows_(rows), backlight_(0x08) {}
+
+  void init() { begin(cols_, rows_); }
+  void begin(uint8_t cols, uint8_t rows) {
+    cols_ = cols;
+    rows_ = rows;
+    delay(50);
+    expanderWrite(backlight_);
+    delay(1000);
+    write4bits(0x03 << 4);
+    delayMicroseconds(4500);
+    write4bits(0x03 << 4);
+    delayMicroseconds(4500);
+    write4bits(0x03 << 4);
+    delayMicroseconds(150);
+    write4bits(0x02 << 4);
+    command(0x28);  // 4-bit, 2 lines
+    command(0x0C);  // Display on
+    clear();
+    command(0x06);  // Entry mode: increment
+    home();
+  }
+  void backlight() { backlight_ = 0x08; expanderWrite(0); }
+  void noBacklight() { backlight_ = 0; expanderWrite(0); }
+
+  void clear() { command(0x01); delayMicroseconds(2000); }
+  void home() { command(0x02); delayMicroseconds(2000); }
+  void setCursor(uint8_t col, uint8_t row) {
+    const uint8_t offsets[4] = { 0x00, 0x40, 0x14, 0x54 };
+    if (row >= rows_) row = rows_ - 1;
+    command(0x80 | (uint8_t)(col + offsets[row]));
+  }
+  size_t write(uint8_t c) { send(c, 0x01); return 1; }
+  using Print::write;
+
+private:
+  uint8_t addr_, cols_, rows_, backlight_;
+
+  void command(uint8_t v) { send(v, 0); }
+  void send(uint8_t v, uint8_t mode) {
+    write4bits((v & 0xF0) | mode);
+    write4bits((uint8_t)((v << 4) & 0xF0) | mode);
+  }
+  void write4bits(uint8_t v) {
+    expanderWrite(v);
+    expanderWrite(v | 0x04);  // Enable high
+    delayMicroseconds(1);
+    expanderWrite(v & ~0x04); // Enable low
+    delayMicroseconds(50);
+  }
+  void expanderWrite(uint8_t v) {
+    Wire.beginTransmission(addr_);
+    Wire.write(v | backlight_);
+    Wire.endTransmission();
+  }
+};
+
+#endif // LIQUIDCRYSTAL_I2C_H
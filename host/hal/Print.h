@@ -0,0 +1,64 @@
+#ifndef PRINT_H
+#define PRINT_H
+
+// ---------------- Host HAL: Print ----------------
+// Subset of the Arduino Print class used by the sketch (LCD, Serial)
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+class __FlashStringHelper;
+
+class Print {
+public:
+  virtual ~Print() {}
+
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t* buf, size_t n) {
+    size_t done = 0;
+    while (n--) done += write(*buf++);
+    return done;
+  }
+  size_t write(const char* s) {
+    return s ? write((const uint8_t*)s, strlen(s)) : 0;
+  }
+  size_t write(const char* buf, size_t n) { return write((const uint8_t*)buf, n); }
+
+  size_t print(const char* s) { return write(s); }
+  size_t print(const __FlashStringHelper* s) { return write((const char*)s); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(unsigned char v, int base = DEC) { return print((unsigned long)v, base); }
+  size_t print(int v, int base = DEC) { return print((long)v, base); }
+  size_t print(unsigned int v, int base = DEC) { return print((unsigned long)v, base); }
+  size_t print(long v, int base = DEC) {
+    if (base == DEC && v < 0) return write((uint8_t)'-') + printNumber((unsigned long)(-v), DEC);
+    return printNumber((unsigned long)v, base);
+  }
+  size_t print(unsigned long v, int base = DEC) { return printNumber(v, base); }
+
+  size_t println() { return write((const uint8_t*)"\r\n", 2); }
+  template <typename T> size_t println(T v) { return print(v) + println(); }
+  template <typename T> size_t println(T v, int base) { return print(v, base) + println(); }
+
+private:
+  size_t printNumber(unsigned long v, int base) {
+    char buf[8 * sizeof(long) + 1];
+    char* p = &buf[sizeof(buf) - 1];
+    *p = 0;
+    if (base < 2) base = 10;
+    do {
+      unsigned long d = v % (unsigned long)base;
+      v /= (unsigned long)base;
+      *--p = (char)(d < 10 ? '0' + d : 'A' + d - 10);
+    } while (v);
+    return write(p);
+  }
+};
+
+#endif // PRINT_H
@@ -0,0 +1,340 @@
+#include "SimHal.h"
+#include <EEPROM.h>
+#include <Wire.h>
+
+HardwareSerial Serial;
+EEPROMClass EEPROM;
+TwoWire Wire;
+
+namespace sim {
+
+// ---------------- State ----------------
+static uint64_t clockUs_ = 0;
+
+struct PinState {
+  uint8_t mode;
+  uint8_t out;
+  bool driven;
+  uint8_t drivenLevel;
+};
+static PinState pins_[NUM_DIGITAL_PINS];
+
+static uint16_t analogValue_[NUM_DIGITAL_PINS];
+static AnalogSource analogSource_ = nullptr;
+static void* analogCtx_ = nullptr;
+static uint32_t analogReads_ = 0;
+
+static uint8_t eeprom_[E2END + 1];
+static uint32_t eepromWrites_[E2END + 1];
+static bool eepromInit_ = false;
+
+static SerialSink serialSink_ = nullptr;
+static void* serialCtx_ = nullptr;
+static uint8_t serialIn_[256];
+static uint16_t serialHead_ = 0, serialTail_ = 0;
+static uint32_t serialBaud_ = 0;
+
+static LcdModel* lcd_ = nullptr;
+
+// ---------------- Clock ----------------
+uint64_t nowMicros() { return clockUs_; }
+void advanceMicros(uint64_t us) { clockUs_ += us; }
+void setMicros(uint64_t us) { clockUs_ = us; }
+
+// ---------------- Pins ----------------
+void drivePin(uint8_t pin, uint8_t level) {
+  if (pin >= NUM_DIGITAL_PINS) return;
+  pins_[pin].driven = true;
+  pins_[pin].drivenLevel = level ? HIGH : LOW;
+}
+
+void releasePin(uint8_t pin) {
+  if (pin >= NUM_DIGITAL_PINS) return;
+  pins_[pin].driven = false;
+}
+
+uint8_t pinMode(uint8_t pin) { return pin < NUM_DIGITAL_PINS ? pins_[pin].mode : INPUT; }
+uint8_t pinOutput(uint8_t pin) { return pin < NUM_DIGITAL_PINS ? pins_[pin].out : LOW; }
+
+// ---------------- ADC ----------------
+void setAnalogValue(uint8_t pin, uint16_t value) {
+  if (pin < NUM_DIGITAL_PINS) analogValue_[pin] = value;
+}
+
+void setAnalogSource(AnalogSource src, void* ctx) {
+  analogSource_ = src;
+  analogCtx_ = ctx;
+}
+
+uint32_t analogReadCount() { return analogReads_; }
+
+// ---------------- EEPROM ----------------
+static void eepromEnsureInit() {
+  if (eepromInit_) return;
+  memset(eeprom_, 0xFF, sizeof(eeprom_));
+  eepromInit_ = true;
+}
+
+uint8_t* eepromData() {
+  eepromEnsureInit();
+  return eeprom_;
+}
+
+void eepromNoteWrite(int idx) { eepromWrites_[idx & E2END]++; }
+
+void eepromErase() {
+  memset(eeprom_, 0xFF, sizeof(eeprom_));
+  eepromInit_ = true;
+}
+
+bool eepromLoad(const char* path) {
+  eepromErase();
+  FILE* f = fopen(path, "rb");
+  if (!f) return false;
+  size_t n = fread(eeprom_, 1, sizeof(eeprom_), f);
+  fclose(f);
+  return n > 0;
+}
+
+bool eepromSave(const char* path) {
+  eepromEnsureInit();
+  FILE* f = fopen(path, "wb");
+  if (!f) return false;
+  size_t n = fwrite(eeprom_, 1, sizeof(eeprom_), f);
+  fclose(f);
+  return n == sizeof(eeprom_);
+}
+
+uint32_t eepromWriteCount(int idx) { return eepromWrites_[idx & E2END]; }
+
+uint32_t eepromTotalWrites() {
+  uint32_t total = 0;
+  for (uint16_t i = 0; i <= E2END; i++) total += eepromWrites_[i];
+  return total;
+}
+
+// ---------------- Serial ----------------
+void setSerialSink(SerialSink sink, void* ctx) {
+  serialSink_ = sink;
+  serialCtx_ = ctx;
+}
+
+void serialInject(const uint8_t* data, size_t n) {
+  while (n--) {
+    uint16_t next = (uint16_t)((serialHead_ + 1) % sizeof(serialIn_));
+    if (next == serialTail_) return;  // Full: drop like a real RX overrun
+    serialIn_[serialHead_] = *data++;
+    serialHead_ = next;
+  }
+}
+
+uint32_t serialBaud() { return serialBaud_; }
+
+// ---------------- LCD ----------------
+LcdModel::LcdModel() : addr_(0), cols_(16), rows_(2), data_(0), commands_(0), byteUs_(0) {
+  memset(ddram_, ' ', sizeof(ddram_));
+}
+
+void LcdModel::configure(uint8_t cols, uint8_t rows) {
+  cols_ = cols;
+  rows_ = rows;
+  memset(ddram_, ' ', sizeof(ddram_));
+  addr_ = 0;
+}
+
+void LcdModel::command(uint8_t cmd) {
+  commands_++;
+  if (cmd & 0x80) {
+    addr_ = cmd & 0x7F;            // Set DDRAM address
+  } else if (cmd == 0x01) {
+    memset(ddram_, ' ', sizeof(ddram_));
+    addr_ = 0;                     // Clear display
+  } else if ((cmd & 0xFE) == 0x02) {
+    addr_ = 0;                     // Return home
+  }
+}
+
+void LcdModel::clear() {
+  command(0x01);
+  delayMicroseconds(2000);  // Clear display command takes ~1.5 ms
+}
+
+void LcdModel::home() {
+  command(0x02);
+  delayMicroseconds(2000);
+}
+
+void LcdModel::setCursor(uint8_t col, uint8_t row) {
+  // Same row offsets as LiquidCrystal::setRowOffsets(0x00, 0x40, cols, 0x40 + cols)
+  const uint8_t offsets[4] = { 0x00, 0x40, cols_, (uint8_t)(0x40 + cols_) };
+  if (row >= 4) row = 3;
+  if (row >= rows_) row = rows_ - 1;
+  addr_ = (uint8_t)((offsets[row] + col) & 0x7F);
+  commands_++;
+  delayMicroseconds(byteUs_);
+}
+
+size_t LcdModel::write(uint8_t c) {
+  ddram_[addr_] = c;
+  // 2-line mode: line 1 is 0x00..0x27, line 2 is 0x40..0x67, each wraps into the other
+  addr_++;
+  if (addr_ == 0x28) addr_ = 0x40;
+  else if (addr_ == 0x68) addr_ = 0x00;
+  data_++;
+  delayMicroseconds(byteUs_);
+  return 1;
+}
+
+char LcdModel::at(uint8_t col, uint8_t row) const {
+  const uint8_t offsets[4] = { 0x00, 0x40, cols_, (uint8_t)(0x40 + cols_) };
+  if (row >= rows_ || col >= cols_) return ' ';
+  return (char)ddram_[(offsets[row] + col) & 0x7F];
+}
+
+void LcdModel::row(uint8_t r, char* out) const {
+  for (uint8_t c = 0; c < cols_; c++) out[c] = at(c, r);
+  out[cols_] = 0;
+}
+
+LcdModel* lcd() { return lcd_; }
+void setActiveLcd(LcdModel* lcd) { lcd_ = lcd; }
+
+// ---------------- I2C bus: PCF8574 LCD backpack ----------------
+// P0=RS, P1=RW, P2=EN, P3=backlight, P4..P7=D4..D7
+class Pcf8574Lcd : public LcdModel {
+public:
+  Pcf8574Lcd() : prev_(0), fourBit_(false), haveHigh_(false), high_(0) {}
+
+  void setGeometry(uint8_t cols, uint8_t rows) { configure(cols, rows); }
+
+  void reset() {
+    prev_ = 0;
+    fourBit_ = false;
+    haveHigh_ = false;
+  }
+
+  void expanderWrite(uint8_t b) {
+    bool fallingEn = (prev_ & 0x04) && !(b & 0x04);
+    prev_ = b;
+    if (!fallingEn) return;
+
+    uint8_t nibble = b >> 4;
+    bool rs = b & 0x01;
+    if (!fourBit_) {
+      // 8-bit interface after power-on: each enable pulse is a full instruction
+      uint8_t cmd = (uint8_t)(nibble << 4);
+      if ((cmd & 0xF0) == 0x20) fourBit_ = true;  // Function set, DL=0
+      return;
+    }
+    if (!haveHigh_) {
+      high_ = nibble;
+      haveHigh_ = true;
+      return;
+    }
+    haveHigh_ = false;
+    uint8_t value = (uint8_t)((high_ << 4) | nibble);
+    if (rs) write(value);
+    else command(value);
+  }
+
+private:
+  uint8_t prev_;
+  bool fourBit_;
+  bool haveHigh_;
+  uint8_t high_;
+};
+
+static Pcf8574Lcd i2cLcd_;
+static uint32_t i2cBytes_ = 0;
+
+void setI2cLcdGeometry(uint8_t cols, uint8_t rows) { i2cLcd_.setGeometry(cols, rows); }
+uint32_t i2cBusBytes() { return i2cBytes_; }
+
+void i2cTransmit(uint8_t addr, const uint8_t* data, uint8_t n, uint32_t clockHz) {
+  // Address byte + payload, 9 clocks each (8 bits + ACK), plus start/stop
+  i2cBytes_ += 1 + n;
+  if (clockHz == 0) clockHz = 100000UL;
+  clockUs_ += ((uint64_t)(1 + n) * 9ULL * 1000000ULL + 2ULL * 1000000ULL) / clockHz;
+
+  bool pcf = (addr >= 0x20 && addr <= 0x27) || (addr >= 0x38 && addr <= 0x3F);
+  if (!pcf) return;
+  if (lcd_ != &i2cLcd_) setActiveLcd(&i2cLcd_);
+  for (uint8_t i = 0; i < n; i++) i2cLcd_.expanderWrite(data[i]);
+}
+
+// ---------------- Reset ----------------
+void reset() {
+  clockUs_ = 0;
+  memset(pins_, 0, sizeof(pins_));
+  memset(analogValue_, 0, sizeof(analogValue_));
+  analogSource_ = nullptr;
+  analogCtx_ = nullptr;
+  analogReads_ = 0;
+  serialHead_ = serialTail_ = 0;
+  lcd_ = nullptr;
+  i2cLcd_.reset();
+  i2cBytes_ = 0;
+}
+
+} // namespace sim
+
+// ---------------- Arduino core API ----------------
+uint32_t millis() { return (uint32_t)(sim::clockUs_ / 1000ULL); }
+uint32_t micros() { return (uint32_t)sim::clockUs_; }
+void delay(uint32_t ms) { sim::clockUs_ += (uint64_t)ms * 1000ULL; }
+void delayMicroseconds(unsigned int us) { sim::clockUs_ += us; }
+
+void pinMode(uint8_t pin, uint8_t mode) {
+  if (pin < NUM_DIGITAL_PINS) sim::pins_[pin].mode = mode;
+}
+
+int digitalRead(uint8_t pin) {
+  if (pin >= NUM_DIGITAL_PINS) return LOW;
+  const sim::PinState& p = sim::pins_[pin];
+  if (p.driven) return p.drivenLevel;
+  if (p.mode == OUTPUT) return p.out;
+  return p.mode == INPUT_PULLUP ? HIGH : LOW;
+}
+
+void digitalWrite(uint8_t pin, uint8_t val) {
+  if (pin < NUM_DIGITAL_PINS) sim::pins_[pin].out = val ? HIGH : LOW;
+}
+
+int analogRead(uint8_t pin) {
+  sim::analogReads_++;
+  uint16_t v;
+  if (sim::analogSource_) v = sim::analogSource_(pin, sim::clockUs_, sim::analogCtx_);
+  else v = pin < NUM_DIGITAL_PINS ? sim::analogValue_[pin] : 0;
+  return v > 1023 ? 1023 : v;
+}
+
+void analogReference(uint8_t mode) { (void)mode; }
+
+void attachInterrupt(int8_t num, void (*isr)(), int mode) { (void)num; (void)isr; (void)mode; }
+void detachInterrupt(int8_t num) { (void)num; }
+
+// ---------------- Serial ----------------
+void HardwareSerial::begin(unsigned long baud) { sim::serialBaud_ = (uint32_t)baud; }
+
+int HardwareSerial::available() {
+  return (int)((sim::serialHead_ + sizeof(sim::serialIn_) - sim::serialTail_) % sizeof(sim::serialIn_));
+}
+
+int HardwareSerial::read() {
+  if (sim::serialHead_ == sim::serialTail_) return -1;
+  uint8_t c = sim::serialIn_[sim::serialTail_];
+  sim::serialTail_ = (uint16_t)((sim::serialTail_ + 1) % sizeof(sim::serialIn_));
+  return c;
+}
+
+int HardwareSerial::peek() {
+  if (sim::serialHead_ == sim::serialTail_) return -1;
+  return sim::serialIn_[sim::serialTail_];
+}
+
+int HardwareSerial::availableForWrite() { return 63; }
+
+size_t HardwareSerial::write(uint8_t c) {
+  if (sim::serialSink_) sim::serialSink_(&c, 1, sim::serialCtx_);
+  return 1;
+}
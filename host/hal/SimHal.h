@@ -0,0 +1,120 @@
+#ifndef SIMHAL_H
+#define SIMHAL_H
+
+// ---------------- Host HAL: simulation control ----------------
+// Everything the sketch sees through Arduino.h / EEPROM.h / LiquidCrystal*.h is backed
+// by the state here. A simulation driver (host/sim/main.cpp, tools) uses this API to
+// advance virtual time, script pins and the ADC, and inspect the LCD framebuffer.
+
+#include <Arduino.h>
+#include <stdint.h>
+
+namespace sim {
+
+// ---------------- Virtual clock ----------------
+uint64_t nowMicros();                 // 64-bit, never wraps
+void advanceMicros(uint64_t us);
+void setMicros(uint64_t us);
+
+// ---------------- Pins ----------------
+// Drive a pin from "outside" (e.g. a button pulling it to GND). A released pin reads
+// HIGH when configured as INPUT_PULLUP, LOW otherwise, or its own output level.
+void drivePin(uint8_t pin, uint8_t level);
+void releasePin(uint8_t pin);
+uint8_t pinMode(uint8_t pin);
+uint8_t pinOutput(uint8_t pin);       // Last digitalWrite() level
+
+// Button helpers (active LOW, as wired on the board)
+inline void pressButton(uint8_t pin) { drivePin(pin, LOW); }
+inline void releaseButton(uint8_t pin) { releasePin(pin); }
+
+// ---------------- ADC ----------------
+// analogRead() returns the source's value for the pin at the current virtual time.
+// Default source: per-pin constant (setAnalogValue, initially 0).
+typedef uint16_t (*AnalogSource)(uint8_t pin, uint64_t micros, void* ctx);
+void setAnalogValue(uint8_t pin, uint16_t value);
+void setAnalogSource(AnalogSource src, void* ctx);
+uint32_t analogReadCount();
+
+// ---------------- EEPROM ----------------
+void eepromErase();                   // All cells 0xFF (fresh chip)
+bool eepromLoad(const char* path);    // false if the file is missing (image left erased)
+bool eepromSave(const char* path);
+uint32_t eepromWriteCount(int idx);   // Physical writes to one cell
+uint32_t eepromTotalWrites();
+
+// ---------------- Serial ----------------
+typedef void (*SerialSink)(const uint8_t* data, size_t n, void* ctx);
+void setSerialSink(SerialSink sink, void* ctx);  // nullptr = discard
+void serialInject(const uint8_t* data, size_t n);
+inline void serialInject(const char* s) { serialInject((const uint8_t*)s, strlen(s)); }
+uint32_t serialBaud();
+
+// ---------------- LCD ----------------
+// HD44780 model: 80-byte DDRAM with the 2-line address map, so the framebuffer shows
+// exactly what the glass would (including writes that overflow into the next row).
+class LcdModel : public Print {
+public:
+  LcdModel();
+
+  void clear();
+  void home();
+  void setCursor(uint8_t col, uint8_t row);
+  void noDisplay() {}
+  void display() {}
+  void noCursor() {}
+  void cursor() {}
+  void noBlink() {}
+  void blink() {}
+  void createChar(uint8_t, uint8_t*) { commands_++; }
+  size_t write(uint8_t c);
+  using Print::write;
+
+  // Raw HD44780 instruction (DDRAM address, clear, home; others are accepted and ignored)
+  void command(uint8_t cmd);
+
+  uint8_t cols() const { return cols_; }
+  uint8_t rows() const { return rows_; }
+  char at(uint8_t col, uint8_t row) const;
+  // Copies one visible row into out (cols + 1 bytes, NUL-terminated)
+  void row(uint8_t r, char* out) const;
+
+  // Virtual time charged per command/data byte (bus + controller execution time).
+  // Stock LiquidCrystal in 4-bit mode spends ~230 us per byte, a 100 kHz PCF8574 ~1 ms.
+  void setByteMicros(uint16_t us) { byteUs_ = us; }
+
+  // Bus traffic counters
+  uint32_t dataWrites() const { return data_; }
+  uint32_t commandWrites() const { return commands_; }
+  void resetCounters() { data_ = 0; commands_ = 0; }
+
+protected:
+  void configure(uint8_t cols, uint8_t rows);
+
+private:
+  uint8_t ddram_[0x80];
+  uint8_t addr_;
+  uint8_t cols_, rows_;
+  uint32_t data_, commands_;
+  uint16_t byteUs_;
+};
+
+// Most recently initialised LCD (nullptr before the sketch calls begin()/init())
+LcdModel* lcd();
+void setActiveLcd(LcdModel* lcd);
+
+// PCF8574 backpack on the I2C bus (any address in 0x20..0x27 / 0x38..0x3F): expander
+// writes are decoded into HD44780 nibbles on falling EN edges and drive this model.
+// It becomes the active LCD on the first transmission. Bus time at the configured
+// clock is charged to the virtual clock (9 bit times per byte).
+void setI2cLcdGeometry(uint8_t cols, uint8_t rows);
+uint32_t i2cBusBytes();
+
+// ---------------- Reset ----------------
+// Clock to 0, pins released, ADC constants cleared, serial input drained.
+// EEPROM contents are kept (like a power cycle).
+void reset();
+
+} // namespace sim
+
+#endif // SIMHAL_H
@@ -0,0 +1,53 @@
+#ifndef WIRE_H
+#define WIRE_H
+
+// ---------------- Host HAL: Wire (I2C master) ----------------
+// Counts bytes and transactions and forwards each transmission to SimHal's bus model.
+
+#include <Arduino.h>
+
+#define BUFFER_LENGTH 32
+
+namespace sim {
+  // Delivers a finished transmission to the simulated bus (PCF8574 LCD backpack)
+  void i2cTransmit(uint8_t addr, const uint8_t* data, uint8_t n, uint32_t clockHz);
+}
+
+class TwoWire : public Print {
+public:
+  TwoWire() : clock_(100000UL), txAddr_(0), txLen_(0), transactions_(0), bytes_(0) {}
+
+  void begin() {}
+  void setClock(uint32_t hz) { clock_ = hz; }
+  void beginTransmission(uint8_t addr) { txAddr_ = addr; txLen_ = 0; }
+  uint8_t endTransmission(bool stop = true) {
+    (void)stop;
+    transactions_++;
+    bytes_ += 1 + txLen_;  // Address byte + payload
+    sim::i2cTransmit(txAddr_, txBuf_, txLen_, clock_);
+    txLen_ = 0;
+    return 0;
+  }
+  size_t write(uint8_t c) {
+    if (txLen_ >= BUFFER_LENGTH) return 0;
+    txBuf_[txLen_++] = c;
+    return 1;
+  }
+  using Print::write;
+
+  uint32_t clock() const { return clock_; }
+  uint32_t transactions() const { return transactions_; }
+  uint32_t bytesOnBus() const { return bytes_; }
+
+private:
+  uint32_t clock_;
+  uint8_t txAddr_;
+  uint8_t txBuf_[BUFFER_LENGTH];
+  uint8_t txLen_;
+  uint32_t transactions_;
+  uint32_t bytes_;
+};
+
+extern TwoWire Wire;
+
+#endif // WIRE_H
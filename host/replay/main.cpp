@@ -0,0 +1,477 @@
+// ---------------- ADC trace replay ----------------
+// Replays a recorded ADC trace through the real firmware and reports speed and what the
+// display showed, so a change to calibration or display filtering can be judged before
+// it reaches hardware.
+//
+//   p3022_replay [--eeprom FILE] [--adc-bits N] [--period-us N] [--step-deg X]
+//                [--settle-deg X] [--check-overshoot] [--out FILE]
+//                [--golden FILE [--update-golden]] TRACE
+//
+// TRACE     One ADC value per line (ADC_MAX scale, one every --period-us, default one
+//           averaging block), or the CSV written by p3022_telemetry (time_us + adc columns)
+// --eeprom  Settings/calibration of the unit the trace came from (default: defaults)
+// --adc-bits Resolution of the trace values if not ADC_BITS (e.g. 10 for old logs)
+//
+// Three passes over the same samples:
+//   1. Pipeline: adcToShown100() + the MAIN screen DisplayFilter, as fast as possible,
+//      repeated for >= 0.5 s -> samples/second (stderr). Also the conversion alone,
+//      scalar and batch (AngleBatch.h); the batch results are checked against the
+//      scalar ones for every input value (exit status 1 if any differs).
+//   2. Firmware: setup()/loop() on the virtual clock with the ADC following the trace;
+//      every change of the LCD is logged with its time since the trace start.
+//   3. Steps: wherever the input angle moves to a new level --step-deg (default 5°) or
+//      more away and stays there >= 0.2 s, the time until the displayed (filtered) angle
+//      stays within --settle-deg (default 0.2°) of the new level, and the overshoot.
+// The report (2 and 3, deterministic) goes to --out or stdout. --golden compares it with
+// a stored report and exits with 1 on any difference; --update-golden rewrites the file.
+// --check-overshoot exits with 1 if any step overshoots by more than the display
+// hysteresis (DISPLAY_HYSTERESIS_100), i.e. the display visibly swings past the target.
+
+#include <stdarg.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include "SimHal.h"
+#include "P3022-CW360-Batton_V1.2.ino"
+#include "AngleBatch.h"
+
+namespace {
+
+struct Sample {
+  uint64_t atUs;  // Since the trace start
+  uint16_t adc;   // 0..ADC_MAX
+};
+
+// Plain values, or p3022_telemetry CSV (header line names the columns)
+bool loadTrace(const char* path, uint32_t periodUs, uint8_t adcBits, std::vector<Sample>& out) {
+  FILE* f = fopen(path, "r");
+  if (!f) return false;
+  char line[512];
+  int timeCol = -1, adcCol = -1;
+  uint64_t t = 0;
+  bool firstTime = true;
+  uint32_t t0 = 0;
+  while (fgets(line, sizeof(line), f)) {
+    char* hash = strchr(line, '#');
+    if (hash) *hash = 0;
+    if (strstr(line, "time_us")) {
+      // Header: find the columns
+      int col = 0;
+      for (char* tok = strtok(line, ",\r\n"); tok; tok = strtok(nullptr, ",\r\n"), col++) {
+        if (strcmp(tok, "time_us") == 0) timeCol = col;
+        if (strcmp(tok, "adc") == 0) adcCol = col;
+      }
+      continue;
+    }
+    long v = -1;
+    uint32_t ts = 0;
+    if (adcCol >= 0) {
+      int col = 0;
+      for (char* tok = strtok(line, ",\r\n"); tok; tok = strtok(nullptr, ",\r\n"), col++) {
+        if (col == adcCol) v = strtol(tok, nullptr, 10);
+        if (col == timeCol) ts = (uint32_t)strtoul(tok, nullptr, 10);
+      }
+      if (v < 0) continue;
+      if (firstTime) t0 = ts;
+      t += firstTime ? 0 : (uint32_t)(ts - t0);  // Unwraps micros() overflow
+      t0 = ts;
+      firstTime = false;
+    } else {
+      char* end;
+      v = strtol(line, &end, 10);
+      if (end == line) continue;
+      if (!firstTime) t += periodUs;
+      firstTime = false;
+    }
+    // Same rule as adcRescale() for stored calibration values (centre of the codes)
+    if (adcBits < ADC_BITS) v = (v << (ADC_BITS - adcBits)) + (1L << (ADC_BITS - adcBits - 1));
+    else if (adcBits > ADC_BITS) v >>= (adcBits - ADC_BITS);
+    if (v > ADC_FULL_SCALE) v = ADC_FULL_SCALE;
+    out.push_back(Sample{ t, (uint16_t)v });
+  }
+  fclose(f);
+  return true;
+}
+
+// ---------------- Trace as the ADC input ----------------
+struct TraceSource {
+  const std::vector<Sample>* trace;
+  uint64_t startUs;  // Virtual time of the first sample
+  size_t pos;
+  uint32_t calls;
+};
+
+// analogRead() value at the current virtual time (step-hold). The firmware sums blocks
+// of 2^ADC_AVG_SHIFT 10-bit reads; spreading the extra bits over the reads (base + 0/1)
+// makes every block sum decimate to exactly the trace value.
+uint16_t traceAnalog(uint8_t, uint64_t now, void* ctx) {
+  TraceSource& s = *(TraceSource*)ctx;
+  const std::vector<Sample>& tr = *s.trace;
+  uint64_t t = (now > s.startUs) ? now - s.startUs : 0;
+  while (s.pos + 1 < tr.size() && tr[s.pos + 1].atUs <= t) s.pos++;
+  const uint16_t EXTRA_MASK = (1U << ADC_EXTRA_BITS) - 1;
+  uint16_t v = tr[s.pos].adc;
+  uint16_t base = v >> ADC_EXTRA_BITS;
+  uint32_t phase = s.calls++ & EXTRA_MASK;
+  if (ADC_EXTRA_BITS == 0) return base;
+  return (uint16_t)(base + (phase < (v & EXTRA_MASK) ? 1 : 0));
+}
+
+std::string lcdRowText(const sim::LcdModel& lcd, uint8_t r) {
+  char buf[41];
+  lcd.row(r, buf);
+  std::string s;
+  for (const char* p = buf; *p; p++) {
+    if ((uint8_t)*p == 0xDF) s += "\xC2\xB0";
+    else if ((uint8_t)*p < 0x20 || (uint8_t)*p > 0x7E) s += '?';
+    else s += *p;
+  }
+  return s;
+}
+
+std::string fmt(const char* f, ...) __attribute__((format(printf, 1, 2)));
+std::string fmt(const char* f, ...) {
+  char buf[512];
+  va_list ap;
+  va_start(ap, f);
+  vsnprintf(buf, sizeof(buf), f, ap);
+  va_end(ap);
+  return buf;
+}
+
+std::string deg(int32_t a100) {
+  return fmt("%s%d.%02d", a100 < 0 ? "-" : "", abs(a100) / 100, abs(a100) % 100);
+}
+
+struct DisplayPoint {
+  uint64_t atUs;  // Since the trace start
+  uint16_t value; // displayFilter.value()
+};
+
+// ---------------- Pass 1: pipeline throughput ----------------
+volatile uint32_t benchSink_;  // Keeps the benchmarked results alive
+
+// Samples/s of step(samples) called repeatedly for >= 0.5 s
+template <class Step>
+double benchRate(size_t samples, const Step& step) {
+  typedef std::chrono::steady_clock Clock;
+  uint64_t n = 0;
+  Clock::time_point start = Clock::now();
+  double wall = 0;
+  do {
+    step();
+    n += samples;
+    wall = std::chrono::duration<double>(Clock::now() - start).count();
+  } while (wall < 0.5);
+  return n / wall;
+}
+
+// Batch conversion (AngleBatch.h) against the scalar functions, for every input value
+bool checkBatch(const AngleBatchContext& ctx) {
+  std::vector<uint16_t> codes(65536), angle(65536), shown(65536);
+  for (uint32_t i = 0; i < 65536; i++) codes[i] = (uint16_t)i;
+  adcToAngle100Batch(ctx, codes.data(), angle.data(), codes.size());
+  adcToShown100Batch(ctx, codes.data(), shown.data(), codes.size());
+  for (uint32_t i = 0; i < 65536; i++) {
+    if (angle[i] != adcToAngle100(codes[i]) || shown[i] != adcToShown100(codes[i])) {
+      fprintf(stderr, "batch conversion differs at adc %u: %u/%u, scalar %u/%u\n", i, angle[i], shown[i],
+              adcToAngle100(codes[i]), adcToShown100(codes[i]));
+      return false;
+    }
+  }
+  return true;
+}
+
+bool benchPipeline(const std::vector<Sample>& trace) {
+  std::vector<uint16_t> adc(trace.size()), out(trace.size());
+  for (size_t i = 0; i < trace.size(); i++) adc[i] = trace[i].adc;
+  static AngleBatchContext ctx;  // ADC_MAX + 1 words
+  angleBatchInit(ctx);
+
+  uint32_t sink = 0;
+  double rate = benchRate(adc.size(), [&]() {
+    DisplayFilter f;
+    for (uint16_t a : adc) sink += f.process(adcToShown100(a));
+  });
+  fprintf(stderr, "pipeline (adcToShown100 + DisplayFilter): %.2f Msamples/s\n", rate / 1e6);
+
+  rate = benchRate(adc.size(), [&]() {
+    for (uint16_t a : adc) sink += applyZero100(adcToAngle100(a));
+  });
+  fprintf(stderr, "conversion (adcToAngle100 + applyZero100): %.2f Msamples/s\n", rate / 1e6);
+
+  double scalar = benchRate(adc.size(), [&]() {
+    for (size_t i = 0; i < adc.size(); i++) out[i] = adcToShown100(adc[i]);
+    sink += out[adc.size() / 2];
+  });
+  double batch = benchRate(adc.size(), [&]() {
+    adcToShown100Batch(ctx, adc.data(), out.data(), adc.size());
+    sink += out[adc.size() / 2];
+  });
+  fprintf(stderr, "conversion (adcToShown100): %.2f Msamples/s scalar, %.2f batch (x%.1f, %s)\n",
+          scalar / 1e6, batch / 1e6, batch / scalar, ctx.table ? "table" : "line");
+  benchSink_ = sink;
+  return checkBatch(ctx);
+}
+
+// ---------------- Pass 3: step settling ----------------
+static const uint64_t MIN_PLATEAU_US = 200000;  // Shorter levels (spikes) are not steps
+
+struct Plateau {
+  size_t first, end;  // Sample range
+  uint16_t level;     // Median of the second half (robust to noise and to the jump)
+};
+
+// Median angle of samples [first, end)
+uint16_t medianAngle(const std::vector<uint16_t>& in, size_t first, size_t end) {
+  uint16_t ref = in[first];
+  std::vector<int16_t> off;
+  for (size_t j = first; j < end; j++) off.push_back(anglefilter::diff(in[j], ref));
+  std::sort(off.begin(), off.end());
+  return anglefilter::wrap((int32_t)ref + off[off.size() / 2]);
+}
+
+uint16_t plateauLevel(const std::vector<uint16_t>& in, size_t first, size_t end) {
+  return medianAngle(in, first + (end - first) / 2, end);
+}
+
+// A ramp, not a level: the input moved on without a jump (halves differ by a step)
+bool isRamp(const std::vector<uint16_t>& in, const Plateau& p, uint16_t stepThr100) {
+  size_t mid = p.first + (p.end - p.first) / 2;
+  return anglefilter::absDiff(medianAngle(in, p.first, mid), p.level) >= stepThr100;
+}
+
+// Returns the largest overshoot (centidegrees)
+int32_t analyzeSteps(const std::vector<Sample>& trace, const std::vector<DisplayPoint>& shown,
+                     uint16_t stepThr100, uint16_t settleTol100, std::vector<std::string>& report) {
+  std::vector<uint16_t> in(trace.size());
+  for (size_t i = 0; i < trace.size(); i++) in[i] = adcToShown100(trace[i].adc);
+
+  // Split at every jump, fold short pieces into the plateau before them, then keep
+  // the boundaries where the level really changed
+  std::vector<Plateau> plateaus;
+  size_t first = 0;
+  for (size_t i = 1; i <= in.size(); i++) {
+    if (i < in.size() && anglefilter::absDiff(in[i], in[i - 1]) < stepThr100) continue;
+    uint64_t tEnd = (i < in.size()) ? trace[i].atUs : trace.back().atUs + 1;
+    if (!plateaus.empty() && tEnd - trace[first].atUs < MIN_PLATEAU_US) {
+      plateaus.back().end = i;
+    } else {
+      plateaus.push_back(Plateau{ first, i, 0 });
+    }
+    first = i;
+  }
+  std::vector<Plateau> levels;
+  for (Plateau& p : plateaus) {
+    p.level = plateauLevel(in, p.first, p.end);
+    if (!levels.empty() && anglefilter::absDiff(p.level, levels.back().level) < stepThr100) {
+      levels.back().end = p.end;
+      levels.back().level = plateauLevel(in, levels.back().first, p.end);
+    } else {
+      levels.push_back(p);
+    }
+  }
+
+  report.push_back(fmt("## steps (>= %s deg, settled within %s deg)", deg(stepThr100).c_str(),
+                       deg(settleTol100).c_str()));
+  size_t d = 0;
+  int32_t worst = 0;
+  for (size_t k = 1; k < levels.size(); k++) {
+    const Plateau& p = levels[k];
+    uint16_t from = levels[k - 1].level;
+    uint64_t t0 = trace[p.first].atUs;
+    uint64_t t1 = (p.end < trace.size()) ? trace[p.end].atUs : UINT64_MAX;
+    int16_t dir = anglefilter::diff(p.level, from);
+    while (d < shown.size() && shown[d].atUs < t0) d++;
+    if (isRamp(in, p, stepThr100)) {
+      report.push_back(fmt("ramp at %.3f s: %s -> %s deg (no level to settle on)", t0 / 1e6,
+                           deg(from).c_str(), deg(p.level).c_str()));
+      continue;
+    }
+
+    // Settled once the display stays inside the band until the next step
+    bool settled = false;
+    uint64_t lastOut = t0;
+    int32_t overshoot = 0;
+    for (size_t j = d; j < shown.size() && shown[j].atUs < t1; j++) {
+      int16_t e = anglefilter::diff(shown[j].value, p.level);
+      if ((uint16_t)abs(e) > settleTol100) {
+        lastOut = shown[j].atUs;
+        settled = false;
+      } else {
+        settled = true;
+      }
+      int32_t past = (dir >= 0) ? e : -e;  // Beyond the target in the step direction
+      if (past > overshoot) overshoot = past;
+    }
+    std::string line = fmt("step %zu at %.3f s: %s -> %s deg, ", k, t0 / 1e6,
+                           deg(from).c_str(), deg(p.level).c_str());
+    if (settled) line += fmt("settled in %.1f ms", (lastOut - t0) / 1e3);
+    else line += "not settled";
+    line += fmt(", overshoot %s deg", deg(overshoot).c_str());
+    report.push_back(line);
+    if (overshoot > worst) worst = overshoot;
+  }
+  if (levels.size() < 2) report.push_back("no steps");
+  return worst;
+}
+
+void usage() {
+  fprintf(stderr,
+          "usage: p3022_replay [--eeprom FILE] [--adc-bits N] [--period-us N] [--step-deg X]\n"
+          "                    [--settle-deg X] [--check-overshoot] [--out FILE]\n"
+          "                    [--golden FILE [--update-golden]] TRACE\n");
+}
+
+// First difference between two reports, with a few lines of each side
+void printDiff(const std::vector<std::string>& want, const std::vector<std::string>& got) {
+  size_t i = 0;
+  while (i < want.size() && i < got.size() && want[i] == got[i]) i++;
+  size_t differing = 0;
+  for (size_t j = 0; j < std::max(want.size(), got.size()); j++) {
+    if (j >= want.size() || j >= got.size() || want[j] != got[j]) differing++;
+  }
+  fprintf(stderr, "golden mismatch from line %zu (%zu of %zu/%zu lines differ):\n", i + 1,
+          differing, want.size(), got.size());
+  for (size_t j = i; j < i + 5 && j < want.size(); j++) fprintf(stderr, "- %s\n", want[j].c_str());
+  for (size_t j = i; j < i + 5 && j < got.size(); j++) fprintf(stderr, "+ %s\n", got[j].c_str());
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  const char* eepromPath = nullptr;
+  const char* outPath = nullptr;
+  const char* goldenPath = nullptr;
+  const char* tracePath = nullptr;
+  bool updateGolden = false;
+  bool checkOvershoot = false;
+  uint8_t adcBits = ADC_BITS;
+  uint32_t periodUs = ADC_BLOCK_US;
+  double stepDeg = 5.0;
+  double settleDeg = 0.2;
+
+  for (int i = 1; i < argc; i++) {
+    std::string a = argv[i];
+    bool hasNext = i + 1 < argc;
+    if (a == "--eeprom" && hasNext) eepromPath = argv[++i];
+    else if (a == "--adc-bits" && hasNext) adcBits = (uint8_t)atoi(argv[++i]);
+    else if (a == "--period-us" && hasNext) periodUs = (uint32_t)atoi(argv[++i]);
+    else if (a == "--step-deg" && hasNext) stepDeg = atof(argv[++i]);
+    else if (a == "--settle-deg" && hasNext) settleDeg = atof(argv[++i]);
+    else if (a == "--out" && hasNext) outPath = argv[++i];
+    else if (a == "--golden" && hasNext) goldenPath = argv[++i];
+    else if (a == "--update-golden") updateGolden = true;
+    else if (a == "--check-overshoot") checkOvershoot = true;
+    else if (!tracePath && a[0] != '-') tracePath = argv[i];
+    else { usage(); return 2; }
+  }
+  if (!tracePath || (updateGolden && !goldenPath) || periodUs == 0) { usage(); return 2; }
+
+  std::vector<Sample> trace;
+  if (!loadTrace(tracePath, periodUs, adcBits, trace) || trace.empty()) {
+    fprintf(stderr, "cannot read trace %s\n", tracePath);
+    return 1;
+  }
+
+  sim::reset();
+  sim::setI2cLcdGeometry(LCD_COLS, LCD_ROWS);
+  if (eepromPath) sim::eepromLoad(eepromPath);
+  TraceSource src = { &trace, 0, 0, 0 };
+  sim::setAnalogSource(traceAnalog, &src);
+
+  // ---------------- Pass 2: firmware replay ----------------
+  typedef std::chrono::steady_clock Clock;
+  Clock::time_point wallStart = Clock::now();
+  setup();
+  src.startUs = sim::nowMicros();  // The trace starts once the menu is up
+  const uint64_t endUs = src.startUs + trace.back().atUs + 2000000;  // 2 s to settle
+  std::vector<std::string> report;
+  std::vector<std::string> lcdLog;
+  std::vector<std::string> rows;
+  std::vector<DisplayPoint> shown;
+  while (sim::nowMicros() < endUs) {
+    loop();
+    uint64_t t = sim::nowMicros() - src.startUs;
+    shown.push_back(DisplayPoint{ t, displayFilter.value() });
+    if (sim::lcd()) {
+      const sim::LcdModel& lcd = *sim::lcd();
+      rows.resize(lcd.rows());
+      bool changed = false;
+      for (uint8_t r = 0; r < lcd.rows(); r++) {
+        std::string row = lcdRowText(lcd, r);
+        if (row != rows[r]) { rows[r] = row; changed = true; }
+      }
+      if (changed) {
+        std::string line = fmt("%10.3f", t / 1e6);
+        for (const std::string& row : rows) line += " |" + row + "|";
+        lcdLog.push_back(line);
+      }
+    }
+    sim::advanceMicros(1000);
+  }
+  double replayWall = std::chrono::duration<double>(Clock::now() - wallStart).count();
+
+  report.push_back(fmt("# p3022_replay: %zu samples, %.3f s, LCD %dx%d", trace.size(),
+                       trace.back().atUs / 1e6, LCD_COLS, LCD_ROWS));
+  report.push_back(fmt("settings: zero %s deg, cal %u..%u, flags 0x%02X, cal table %s", deg(S.zero100).c_str(),
+                       S.calMin, S.calMax, S.flags, calTableActive() ? "on" : "off"));
+  int32_t overshoot = analyzeSteps(trace, shown, (uint16_t)(stepDeg * 100 + 0.5),
+                                   (uint16_t)(settleDeg * 100 + 0.5), report);
+  report.push_back(fmt("## lcd (%zu frames)", lcdLog.size()));
+  report.insert(report.end(), lcdLog.begin(), lcdLog.end());
+
+  // ---------------- Pass 1 (after the replay: same settings, warm caches) ----------------
+  fprintf(stderr, "replay: %.3f s simulated in %.3f s wall\n", (endUs - src.startUs) / 1e6, replayWall);
+  if (!benchPipeline(trace)) return 1;
+
+  // ---------------- Output / golden comparison ----------------
+  FILE* out = outPath ? fopen(outPath, "w") : (goldenPath ? nullptr : stdout);
+  if (outPath && !out) {
+    fprintf(stderr, "cannot write %s\n", outPath);
+    return 1;
+  }
+  if (out) {
+    for (const std::string& l : report) fprintf(out, "%s\n", l.c_str());
+    if (out != stdout) fclose(out);
+  }
+  if (checkOvershoot && overshoot > DISPLAY_HYSTERESIS_100) {
+    fprintf(stderr, "overshoot %s deg exceeds the display hysteresis (%s deg)\n", deg(overshoot).c_str(),
+            deg(DISPLAY_HYSTERESIS_100).c_str());
+    return 1;
+  }
+  if (!goldenPath) return 0;
+
+  if (updateGolden) {
+    FILE* g = fopen(goldenPath, "w");
+    if (!g) {
+      fprintf(stderr, "cannot write %s\n", goldenPath);
+      return 1;
+    }
+    for (const std::string& l : report) fprintf(g, "%s\n", l.c_str());
+    fclose(g);
+    fprintf(stderr, "golden: %s updated\n", goldenPath);
+    return 0;
+  }
+  FILE* g = fopen(goldenPath, "r");
+  if (!g) {
+    fprintf(stderr, "cannot read %s\n", goldenPath);
+    return 1;
+  }
+  std::vector<std::string> want;
+  char line[1024];
+  while (fgets(line, sizeof(line), g)) {
+    std::string l = line;
+    while (!l.empty() && (l.back() == '\n' || l.back() == '\r')) l.pop_back();
+    want.push_back(l);
+  }
+  fclose(g);
+  if (want == report) {
+    fprintf(stderr, "golden: match (%zu lines)\n", report.size());
+    return 0;
+  }
+  printDiff(want, report);
+  return 1;
+}
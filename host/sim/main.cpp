@@ -0,0 +1,246 @@
+// ---------------- Headless sketch runner ----------------
+// Runs setup()/loop() of the real sketch against the host HAL with a virtual clock.
+//
+//   p3022_sim [--seconds N] [--step-us N] [--script FILE] [--eeprom FILE] [--adc N]
+//             [--lcd] [--lcd-byte-us N] [--quiet] [--serial-pty]
+//
+// Serial output goes to stdout, or with --serial-pty to a new pseudo-terminal that
+// stands in for the board's serial port (path printed on stderr; the run starts once a
+// reader has opened it, e.g. host/telemetry/p3022_telemetry).
+//
+// Script lines: "<t_ms> <command> [args]", '#' starts a comment.
+//   adc <value>          ADC value on PIN_ANGLE from t_ms on (step-hold)
+//   press <button|pin>   Button UP/DOWN/OK/BACK (or pin number) pulled to GND
+//   release <button|pin>
+//   serial <text>        Bytes injected into Serial RX
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "SimHal.h"
+#include "P3022-CW360-Batton_V1.2.ino"
+
+namespace {
+
+struct ScriptEvent {
+  uint64_t atUs;
+  std::string cmd;
+  std::string arg;
+};
+
+bool loadScript(const char* path, std::vector<ScriptEvent>& out) {
+  FILE* f = fopen(path, "r");
+  if (!f) return false;
+  char line[512];
+  while (fgets(line, sizeof(line), f)) {
+    char* hash = strchr(line, '#');
+    if (hash) *hash = 0;
+    double tMs = 0;
+    char cmd[32] = {0};
+    int used = 0;
+    if (sscanf(line, "%lf %31s %n", &tMs, cmd, &used) < 2) continue;
+    std::string arg = line + used;
+    while (!arg.empty() && (arg.back() == '\n' || arg.back() == '\r' || arg.back() == ' ')) arg.pop_back();
+    out.push_back(ScriptEvent{ (uint64_t)(tMs * 1000.0), cmd, arg });
+  }
+  fclose(f);
+  std::stable_sort(out.begin(), out.end(),
+                   [](const ScriptEvent& a, const ScriptEvent& b) { return a.atUs < b.atUs; });
+  return true;
+}
+
+int buttonPin(const std::string& name) {
+  if (name == "UP") return PIN_BTN_UP;
+  if (name == "DOWN") return PIN_BTN_DOWN;
+  if (name == "OK") return PIN_BTN_OK;
+  if (name == "BACK") return PIN_BTN_BACK;
+  return atoi(name.c_str());
+}
+
+void applyEvent(const ScriptEvent& e) {
+  if (e.cmd == "adc") {
+    sim::setAnalogValue(PIN_ANGLE, (uint16_t)atoi(e.arg.c_str()));
+  } else if (e.cmd == "press") {
+    sim::pressButton((uint8_t)buttonPin(e.arg));
+  } else if (e.cmd == "release") {
+    sim::releaseButton((uint8_t)buttonPin(e.arg));
+  } else if (e.cmd == "serial") {
+    std::string s = e.arg + "\n";
+    sim::serialInject(s.c_str());
+  } else {
+    fprintf(stderr, "script: unknown command '%s'\n", e.cmd.c_str());
+  }
+}
+
+void serialToStdout(const uint8_t* data, size_t n, void*) {
+  fwrite(data, 1, n, stdout);
+}
+
+void serialToFd(const uint8_t* data, size_t n, void* ctx) {
+  int fd = *(int*)ctx;
+  while (n > 0) {
+    ssize_t w = write(fd, data, n);  // Blocks while the reader lags: no bytes are lost
+    if (w <= 0) return;
+    data += w;
+    n -= (size_t)w;
+  }
+}
+
+// Pseudo-terminal in raw mode; returns the master fd after a reader opened the slave
+int openSerialPty() {
+  int fd = posix_openpt(O_RDWR | O_NOCTTY);
+  if (fd < 0 || grantpt(fd) != 0 || unlockpt(fd) != 0) return -1;
+  termios t;
+  tcgetattr(fd, &t);
+  cfmakeraw(&t);
+  tcsetattr(fd, TCSANOW, &t);
+  fprintf(stderr, "serial: %s (waiting for a reader)\n", ptsname(fd));
+
+  // The master sees a hangup until the slave side is opened
+  for (;;) {
+    pollfd p = { fd, POLLOUT, 0 };
+    if (poll(&p, 1, 100) > 0 && !(p.revents & POLLHUP)) return fd;
+  }
+}
+
+// Wait (up to 2 s) until the reader has taken everything written to the pty; closing
+// the master discards what is still queued. The queue is the slave's input, so ask there;
+// the kernel moves data into it in steps, so it has to stay empty for a while.
+void drainSerialPty(int fd) {
+  int slave = open(ptsname(fd), O_RDONLY | O_NOCTTY | O_NONBLOCK);
+  if (slave < 0) return;
+  int empty = 0;
+  for (int i = 0; i < 200 && empty < 10; i++) {
+    int queued = 0;
+    if (ioctl(slave, FIONREAD, &queued) != 0) break;
+    empty = (queued == 0) ? empty + 1 : 0;
+    usleep(10000);
+  }
+  close(slave);
+}
+
+// LCD rows with the HD44780 degree glyph (0xDF) shown as UTF-8
+std::string lcdRowText(const sim::LcdModel& lcd, uint8_t r) {
+  char buf[41];
+  lcd.row(r, buf);
+  std::string s;
+  for (const char* p = buf; *p; p++) {
+    if ((uint8_t)*p == 0xDF) s += "\xC2\xB0";
+    else if ((uint8_t)*p < 0x20 || (uint8_t)*p > 0x7E) s += '?';
+    else s += *p;
+  }
+  return s;
+}
+
+void usage() {
+  fprintf(stderr,
+          "usage: p3022_sim [--seconds N] [--step-us N] [--script FILE] [--eeprom FILE]\n"
+          "                 [--adc N] [--lcd] [--lcd-byte-us N] [--quiet] [--serial-pty]\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  double seconds = 10.0;
+  uint32_t stepUs = 1000;
+  const char* scriptPath = nullptr;
+  const char* eepromPath = nullptr;
+  int adc = 512;
+  bool printLcd = false;
+  int lcdByteUs = 0;
+  bool quiet = false;
+  bool serialPty = false;
+
+  for (int i = 1; i < argc; i++) {
+    std::string a = argv[i];
+    bool hasNext = i + 1 < argc;
+    if (a == "--seconds" && hasNext) seconds = atof(argv[++i]);
+    else if (a == "--step-us" && hasNext) stepUs = (uint32_t)atoi(argv[++i]);
+    else if (a == "--script" && hasNext) scriptPath = argv[++i];
+    else if (a == "--eeprom" && hasNext) eepromPath = argv[++i];
+    else if (a == "--adc" && hasNext) adc = atoi(argv[++i]);
+    else if (a == "--lcd") printLcd = true;
+    else if (a == "--lcd-byte-us" && hasNext) lcdByteUs = atoi(argv[++i]);
+    else if (a == "--quiet") quiet = true;
+    else if (a == "--serial-pty") serialPty = true;
+    else { usage(); return 2; }
+  }
+  if (stepUs == 0) stepUs = 1;
+
+  std::vector<ScriptEvent> script;
+  if (scriptPath && !loadScript(scriptPath, script)) {
+    fprintf(stderr, "cannot read script %s\n", scriptPath);
+    return 1;
+  }
+
+  sim::reset();
+  sim::setI2cLcdGeometry(LCD_COLS, LCD_ROWS);
+  if (eepromPath) sim::eepromLoad(eepromPath);
+  sim::setAnalogValue(PIN_ANGLE, (uint16_t)adc);
+  int ptyFd = -1;
+  if (serialPty) {
+    ptyFd = openSerialPty();
+    if (ptyFd < 0) {
+      fprintf(stderr, "cannot create a pseudo-terminal\n");
+      return 1;
+    }
+    sim::setSerialSink(serialToFd, &ptyFd);
+  } else if (!quiet) {
+    sim::setSerialSink(serialToStdout, nullptr);
+  }
+
+  const uint64_t endUs = (uint64_t)(seconds * 1e6);
+  size_t next = 0;
+  uint64_t loops = 0;
+  std::vector<std::string> shown;
+
+  auto wallStart = std::chrono::steady_clock::now();
+  setup();
+  if (sim::lcd()) sim::lcd()->setByteMicros((uint16_t)lcdByteUs);
+  while (sim::nowMicros() < endUs) {
+    while (next < script.size() && script[next].atUs <= sim::nowMicros()) applyEvent(script[next++]);
+
+    loop();
+    loops++;
+
+    if (printLcd && sim::lcd()) {
+      const sim::LcdModel& lcd = *sim::lcd();
+      shown.resize(lcd.rows());
+      bool changed = false;
+      for (uint8_t r = 0; r < lcd.rows(); r++) {
+        std::string row = lcdRowText(lcd, r);
+        if (row != shown[r]) { shown[r] = row; changed = true; }
+      }
+      if (changed) {
+        printf("[%10.3f s]", sim::nowMicros() / 1e6);
+        for (const std::string& row : shown) printf(" |%s|", row.c_str());
+        printf("\n");
+      }
+    }
+    sim::advanceMicros(stepUs);
+  }
+  double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+
+  if (eepromPath) sim::eepromSave(eepromPath);
+  if (ptyFd >= 0) {
+    drainSerialPty(ptyFd);
+    close(ptyFd);
+  }
+
+  fprintf(stderr, "simulated %.3f s in %.3f s wall (%.0fx), %llu loop() calls\n",
+          sim::nowMicros() / 1e6, wall, wall > 0 ? (sim::nowMicros() / 1e6) / wall : 0.0,
+          (unsigned long long)loops);
+  if (sim::lcd()) {
+    fprintf(stderr, "lcd: %u data writes, %u commands, %u i2c bytes; eeprom: %u cell writes\n",
+            sim::lcd()->dataWrites(), sim::lcd()->commandWrites(), sim::i2cBusBytes(),
+            sim::eepromTotalWrites());
+  }
+  return 0;
+}
@@ -0,0 +1,32 @@
+# Boots the simulated board three times on one EEPROM image (ctest, see CMakeLists.txt):
+# the first boot may migrate or create the settings, after that a boot must not change a
+# single byte (calMin/calMax stay put, no record written).
+#
+#   cmake -DSIM=p3022_sim -DIMAGE=start.eeprom -DWORK=dir -P reboot_test.cmake
+#
+# IMAGE that does not exist: start from an erased EEPROM.
+
+file(REMOVE_RECURSE ${WORK})
+file(MAKE_DIRECTORY ${WORK})
+set(EE ${WORK}/unit.eeprom)
+if(EXISTS ${IMAGE})
+  configure_file(${IMAGE} ${EE} COPYONLY)
+endif()
+
+foreach(boot 1 2 3)
+  # 8 s: past the splash screen and the settings commit delay
+  execute_process(COMMAND ${SIM} --seconds 8 --quiet --eeprom ${EE}
+                  RESULT_VARIABLE rc ERROR_VARIABLE log)
+  if(NOT rc EQUAL 0)
+    message(FATAL_ERROR "boot ${boot}: p3022_sim failed (${rc}):\n${log}")
+  endif()
+  if(boot GREATER 1)
+    execute_process(COMMAND ${CMAKE_COMMAND} -E compare_files ${EE} ${WORK}/previous.eeprom
+                    RESULT_VARIABLE changed)
+    if(changed)
+      message(FATAL_ERROR "boot ${boot} changed the EEPROM:\n${log}")
+    endif()
+  endif()
+  configure_file(${EE} ${WORK}/previous.eeprom COPYONLY)
+  message(STATUS "boot ${boot}: ${log}")
+endforeach()
@@ -0,0 +1,34 @@
+// termios2 comes from the kernel headers, which clash with glibc's <termios.h>:
+// this file uses only the kernel definitions
+#include "SerialPort.h"
+
+#include <asm/termbits.h>
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+int serialOpen(const char* path, uint32_t baud) {
+  int fd = open(path, O_RDONLY | O_NOCTTY);
+  if (fd < 0) return -1;
+
+  struct termios2 t;
+  if (ioctl(fd, TCGETS2, &t) != 0) {
+    close(fd);
+    return -1;
+  }
+  // Raw input: no echo, no line editing, no CR/LF translation, no flow control
+  t.c_iflag &= ~(IGNBRK | BRKINT | PARMRK | ISTRIP | INLCR | IGNCR | ICRNL | IXON | IXOFF);
+  t.c_oflag &= ~OPOST;
+  t.c_lflag &= ~(ECHO | ECHONL | ICANON | ISIG | IEXTEN);
+  t.c_cflag &= ~(CSIZE | PARENB | CSTOPB | CRTSCTS | CBAUD | (CBAUD << IBSHIFT));
+  t.c_cflag |= CS8 | CREAD | CLOCAL | BOTHER;
+  t.c_ispeed = baud;
+  t.c_ospeed = baud;
+  t.c_cc[VMIN] = 1;
+  t.c_cc[VTIME] = 0;
+  if (ioctl(fd, TCSETS2, &t) != 0) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
@@ -0,0 +1,10 @@
+#ifndef SERIALPORT_H
+#define SERIALPORT_H
+
+#include <stdint.h>
+
+// Open a tty read-only in raw 8N1 mode at any baud rate (termios2, so non-standard
+// rates such as 250000 work); returns the fd or -1 with errno set
+int serialOpen(const char* path, uint32_t baud);
+
+#endif // SERIALPORT_H
@@ -0,0 +1,194 @@
+// ---------------- Telemetry decoder / recorder ----------------
+// Reads the binary TELEMETRY stream (Telemetry.h) from the board's serial port, a
+// recorded file or stdin, checks framing and CRC and writes one CSV line per frame.
+//
+//   p3022_telemetry [--baud N] [--csv FILE] [--raw FILE] [--frames N] [--quiet] SOURCE
+//
+// SOURCE   tty device (set to raw mode at --baud, default TELEMETRY_BAUD), file, or '-'
+// --csv    CSV output file instead of stdout
+// --raw    Also record the received bytes unchanged (a raw file is a valid SOURCE)
+// --frames Stop after N good frames (default: until EOF or Ctrl-C)
+// --quiet  No CSV, summary only
+//
+// The summary on stderr counts good frames, CRC and framing errors, frames lost
+// (gaps in seq) and the frame rate over the board's own timestamps.
+// Try it without hardware: p3022_sim (built with P3022_TELEMETRY) --serial-pty
+// prints a pseudo-terminal path that this tool can open like /dev/ttyUSB0.
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <string>
+
+#include "Cobs.h"
+#include "Crc16.h"
+#include "Telemetry.h"
+#include "SerialPort.h"
+
+namespace {
+
+volatile sig_atomic_t stop_ = 0;
+
+void onSignal(int) { stop_ = 1; }
+
+struct Stats {
+  uint64_t frames = 0;
+  uint64_t crcErrors = 0;
+  uint64_t framingErrors = 0;  // Bad COBS, wrong length or unknown version
+  uint64_t lost = 0;
+  uint64_t spanUs = 0;         // Board time from the first to the last frame
+  bool haveLast = false;
+  uint16_t lastSeq = 0;
+  uint32_t lastTimeUs = 0;
+};
+
+class Decoder {
+public:
+  Decoder(FILE* csv, Stats& stats) : csv_(csv), stats_(stats), len_(0), synced_(false), overflow_(false) {}
+
+  // Feed received bytes; every complete frame is checked and counted
+  void feed(const uint8_t* data, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+      uint8_t b = data[i];
+      if (b != 0) {
+        if (len_ < sizeof(buf_)) buf_[len_++] = b;
+        else overflow_ = true;
+        continue;
+      }
+      // Bytes before the first delimiter may be the tail of a frame sent before we
+      // listened: decoded if they are a whole frame, but not counted as an error
+      if (len_ > 0) frame(synced_);
+      synced_ = true;
+      len_ = 0;
+      overflow_ = false;
+    }
+  }
+
+private:
+  FILE* csv_;
+  Stats& stats_;
+  uint8_t buf_[COBS_MAX_ENCODED(sizeof(TelemetryFrame))];
+  size_t len_;
+  bool synced_;
+  bool overflow_;
+
+  void frame(bool countErrors) {
+    uint8_t dec[sizeof(buf_)];
+    int16_t n = overflow_ ? -1 : cobsDecode(buf_, (uint16_t)len_, dec);
+    if (n != (int16_t)sizeof(TelemetryFrame)) {
+      if (countErrors) stats_.framingErrors++;
+      return;
+    }
+    TelemetryFrame f;
+    memcpy(&f, dec, sizeof(f));  // Little-endian, unpadded: same layout as on the AVR
+    if (f.crc != crc16(&f, offsetof(TelemetryFrame, crc))) {
+      if (countErrors) stats_.crcErrors++;
+      return;
+    }
+    if (f.version != TELEMETRY_VERSION) {
+      if (countErrors) stats_.framingErrors++;
+      return;
+    }
+    if (stats_.haveLast) {
+      stats_.lost += (uint16_t)(f.seq - stats_.lastSeq - 1);
+      stats_.spanUs += (uint32_t)(f.timeUs - stats_.lastTimeUs);  // Unwraps micros() overflow
+    }
+    stats_.haveLast = true;
+    stats_.lastSeq = f.seq;
+    stats_.lastTimeUs = f.timeUs;
+    stats_.frames++;
+    if (csv_) {
+      fprintf(csv_, "%u,%u,%u,%u,%u,%u,%u,%d\n", f.timeUs, f.seq, f.flags, f.adc, f.raw100,
+              f.shown100, f.display100, f.rate10);
+    }
+  }
+};
+
+void usage() {
+  fprintf(stderr,
+          "usage: p3022_telemetry [--baud N] [--csv FILE] [--raw FILE] [--frames N] [--quiet] SOURCE\n"
+          "       SOURCE: serial device, recorded file, or - for stdin\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  uint32_t baud = TELEMETRY_BAUD;
+  const char* csvPath = nullptr;
+  const char* rawPath = nullptr;
+  const char* source = nullptr;
+  uint64_t maxFrames = 0;
+  bool quiet = false;
+
+  for (int i = 1; i < argc; i++) {
+    std::string a = argv[i];
+    bool hasNext = i + 1 < argc;
+    if (a == "--baud" && hasNext) baud = (uint32_t)strtoul(argv[++i], nullptr, 10);
+    else if (a == "--csv" && hasNext) csvPath = argv[++i];
+    else if (a == "--raw" && hasNext) rawPath = argv[++i];
+    else if (a == "--frames" && hasNext) maxFrames = strtoull(argv[++i], nullptr, 10);
+    else if (a == "--quiet") quiet = true;
+    else if (!source && (a == "-" || a[0] != '-')) source = argv[i];
+    else { usage(); return 2; }
+  }
+  if (!source) { usage(); return 2; }
+
+  int fd;
+  if (strcmp(source, "-") == 0) {
+    fd = STDIN_FILENO;
+  } else {
+    fd = open(source, O_RDONLY | O_NOCTTY);
+    if (fd >= 0 && isatty(fd)) {
+      close(fd);
+      fd = serialOpen(source, baud);
+    }
+  }
+  if (fd < 0) {
+    fprintf(stderr, "cannot open %s: %s\n", source, strerror(errno));
+    return 1;
+  }
+
+  FILE* csv = nullptr;
+  if (!quiet) {
+    csv = csvPath ? fopen(csvPath, "w") : stdout;
+    if (!csv) {
+      fprintf(stderr, "cannot write %s\n", csvPath);
+      return 1;
+    }
+    fprintf(csv, "time_us,seq,flags,adc,raw100,shown100,display100,rate10\n");
+  }
+  FILE* raw = rawPath ? fopen(rawPath, "wb") : nullptr;
+  if (rawPath && !raw) {
+    fprintf(stderr, "cannot write %s\n", rawPath);
+    return 1;
+  }
+
+  signal(SIGINT, onSignal);
+  signal(SIGTERM, onSignal);
+
+  Stats stats;
+  Decoder decoder(csv, stats);
+  uint8_t buf[4096];
+  while (!stop_ && (maxFrames == 0 || stats.frames < maxFrames)) {
+    ssize_t n = read(fd, buf, sizeof(buf));
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) break;  // EOF, or EIO once the other end of a pty has closed
+    if (raw) fwrite(buf, 1, (size_t)n, raw);
+    decoder.feed(buf, (size_t)n);
+  }
+
+  if (csv && csv != stdout) fclose(csv);
+  if (raw) fclose(raw);
+  double span = stats.spanUs / 1e6;
+  fprintf(stderr, "frames: %llu, crc errors: %llu, framing errors: %llu, lost: %llu, "
+          "span: %.3f s (%.1f frames/s)\n",
+          (unsigned long long)stats.frames, (unsigned long long)stats.crcErrors,
+          (unsigned long long)stats.framingErrors, (unsigned long long)stats.lost, span,
+          span > 0 ? (stats.frames - 1) / span : 0.0);
+  return (stats.crcErrors || stats.framingErrors) ? 3 : 0;
+}